@@ -0,0 +1,186 @@
+#include "libtfutils.h"
+#include "tf_core.hpp"
+
+namespace {
+
+constexpr Jint SIZE_ARGS = 8;
+
+constexpr Jchar COMMAND_CSV[] = "csv";
+constexpr Jchar COMMAND_TRANSFORM[] = "transform";
+constexpr Jchar FORMAT_THREADS[] = "--threads=%d";
+constexpr Jchar OPTION_PIXELS[] = "--pixels";
+
+// The C structs point into storage owned by these; the *_free calls cast back down.
+class Annotation : public tfutils_annotation {
+public:
+  std::list<std::string> mStrings;
+  std::vector<tfutils_object> mObjects;
+
+  Annotation() : tfutils_annotation(), mStrings(), mObjects() {}
+
+  const Jchar *keep(std::string_view v) { return this->mStrings.emplace_back(v).c_str(); }
+};
+
+class Columns : public tfutils_csv {
+public:
+  std::set<std::string, std::less<>> mStrings;
+  std::vector<const Jchar *> mModel;
+  std::vector<const Jchar *> mPath;
+  std::vector<const Jchar *> mTarget;
+  std::vector<Jfloat> mPoints[8];
+
+  Columns() : tfutils_csv(), mStrings(), mModel(), mPath(), mTarget(), mPoints() {}
+
+  const Jchar *keep(const std::string &v) { return this->mStrings.insert(v).first->c_str(); }
+
+  void add(const tfutils::TFCSVRow &row) {
+    this->mModel.push_back(this->keep(row.getModel()));
+    this->mPath.push_back(this->keep(row.getPath()));
+    this->mTarget.push_back(this->keep(row.getTarget()));
+    this->mPoints[0].push_back(row.getX1());
+    this->mPoints[1].push_back(row.getY1());
+    this->mPoints[2].push_back(row.getX2());
+    this->mPoints[3].push_back(row.getY2());
+    this->mPoints[4].push_back(row.getX3());
+    this->mPoints[5].push_back(row.getY3());
+    this->mPoints[6].push_back(row.getX4());
+    this->mPoints[7].push_back(row.getY4());
+  }
+
+  void publish() {
+    this->row_count = this->mModel.size();
+    this->model = this->mModel.data();
+    this->path = this->mPath.data();
+    this->target = this->mTarget.data();
+    this->x1 = this->mPoints[0].data();
+    this->y1 = this->mPoints[1].data();
+    this->x2 = this->mPoints[2].data();
+    this->y2 = this->mPoints[3].data();
+    this->x3 = this->mPoints[4].data();
+    this->y3 = this->mPoints[5].data();
+    this->x4 = this->mPoints[6].data();
+    this->y4 = this->mPoints[7].data();
+  }
+};
+
+// Runs one command exactly as the executable would with the same arguments.
+Jint run(tfutils::AbstractCommand &&command, const std::vector<std::string> &args) {
+  UP<tfutils::ICommandArgs> commandArgs(new tfutils::CommandArgs<SIZE_ARGS>());
+
+  for (auto &&one : args) {
+    if (tfutils::ICommandArgs::isOption(one.c_str()))
+      commandArgs->pushOption(one.c_str());
+    else
+      commandArgs->push(one.c_str());
+  }
+  return command.execute(commandArgs);
+}
+
+std::string getThreads(Jint threads) {
+  return tfutils::String::format(FORMAT_THREADS,
+                                 (threads > 0) ? threads : tfutils::Parallel::getConcurrency());
+}
+
+} // namespace
+
+// No exception may cross into C callers, so every entry point ends in a catch-all.
+
+int tfutils_version(void) { return TFUTILS_API_VERSION; }
+
+int tfutils_xml_parse(const char *path, tfutils_annotation **out) {
+  if ((path == nullptr) || (out == nullptr))
+    return -1;
+
+  *out = nullptr;
+  try {
+    tfutils::LabelImageArena arena;
+    if (!arena.load(path))
+      return -1;
+
+    UP<Annotation> ret(new Annotation());
+    ret->folder = ret->keep(arena.getFolder());
+    ret->filename = ret->keep(arena.getFilename());
+    ret->path = ret->keep(arena.getPath());
+    ret->width = arena.getSize().getWidth();
+    ret->height = arena.getSize().getHeight();
+    ret->depth = arena.getSize().getDepth();
+    ret->segmented = arena.getSegmented();
+
+    for (auto &&object : arena.getObjects()) {
+      auto &&box = object.getBndbox();
+      ret->mObjects.push_back({ret->keep(object.getName()), ret->keep(object.getPose()),
+                               object.getTruncated(), object.getDifficult(), box.getMinX(),
+                               box.getMinY(), box.getMaxX(), box.getMaxY()});
+    }
+    ret->object_count = ret->mObjects.size();
+    ret->objects = ret->mObjects.data();
+    *out = ret.release();
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+void tfutils_xml_free(tfutils_annotation *annotation) {
+  delete static_cast<Annotation *>(annotation);
+}
+
+int tfutils_csv_parse(const char *path, tfutils_csv **out) {
+  if ((path == nullptr) || (out == nullptr))
+    return -1;
+
+  *out = nullptr;
+  try {
+    std::string buffer;
+    std::string_view line;
+    tfutils::TFCSVRow row;
+
+    auto &&in = tfutils::LineReader(path);
+    if (!in.isOpen())
+      return -1;
+
+    UP<Columns> ret(new Columns());
+    while (in.next(line)) {
+      if (tfutils::TFCSV::parseLine(line, row, buffer))
+        ret->add(row);
+    }
+    if (in.isFailed())
+      return -1;
+    ret->publish();
+    *out = ret.release();
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+void tfutils_csv_free(tfutils_csv *csv) { delete static_cast<Columns *>(csv); }
+
+int tfutils_csv_export(const char *directory, const char *out, const char *target, int threads) {
+  if ((directory == nullptr) || (out == nullptr))
+    return -1;
+
+  try {
+    std::vector<std::string> args = {directory, out};
+    if (target != nullptr)
+      args.emplace_back(target);
+    args.push_back(getThreads(threads));
+    return run(tfutils::TensorflowCSV(COMMAND_CSV), args);
+  } catch (...) {
+    return -1;
+  }
+}
+
+int tfutils_augment(const char *in, const char *out, const char *mode, int pixels, int threads) {
+  if ((in == nullptr) || (out == nullptr) || (mode == nullptr))
+    return -1;
+
+  try {
+    std::vector<std::string> args = {in, out, mode, getThreads(threads)};
+    if (pixels != 0)
+      args.emplace_back(OPTION_PIXELS);
+    return run(tfutils::TensorflowTransform(COMMAND_TRANSFORM), args);
+  } catch (...) {
+    return -1;
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef TFUTILS_LIBTFUTILS_H
+#define TFUTILS_LIBTFUTILS_H
+
+/*
+ * C API of libtfutils. Every call returns 0 on success and -1 on failure unless noted
+ * otherwise; results handed out by a *_parse call stay valid until their *_free call.
+ * Paths ending in .gz are read and written gzip compressed. Calls that run a command
+ * (tfutils_csv_export, tfutils_augment) still print its progress and log lines to stdout.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TFUTILS_API __attribute__((visibility("default")))
+#define TFUTILS_API_VERSION 1
+
+typedef struct tfutils_object {
+  const char *name;
+  const char *pose;
+  int truncated;
+  int difficult;
+  int xmin;
+  int ymin;
+  int xmax;
+  int ymax;
+} tfutils_object;
+
+typedef struct tfutils_annotation {
+  const char *folder;
+  const char *filename;
+  const char *path;
+  int width;
+  int height;
+  int depth;
+  int segmented;
+  size_t object_count;
+  const tfutils_object *objects;
+} tfutils_annotation;
+
+/* One entry per CSV row in every column; equal strings share one pointer. */
+typedef struct tfutils_csv {
+  size_t row_count;
+  const char *const *model;
+  const char *const *path;
+  const char *const *target;
+  const float *x1;
+  const float *y1;
+  const float *x2;
+  const float *y2;
+  const float *x3;
+  const float *y3;
+  const float *x4;
+  const float *y4;
+} tfutils_csv;
+
+/* Returns TFUTILS_API_VERSION of the loaded library. */
+TFUTILS_API int tfutils_version(void);
+
+/* Parses one LabelImg XML annotation. */
+TFUTILS_API int tfutils_xml_parse(const char *path, tfutils_annotation **out);
+
+TFUTILS_API void tfutils_xml_free(tfutils_annotation *annotation);
+
+/* Parses a TFCSV file into columns; rows that do not have all 11 fields are skipped. */
+TFUTILS_API int tfutils_csv_parse(const char *path, tfutils_csv **out);
+
+TFUTILS_API void tfutils_csv_free(tfutils_csv *csv);
+
+/* Same as "csv directory out [target] --threads=threads"; target may be NULL and threads 0
+ * picks the hardware concurrency. */
+TFUTILS_API int tfutils_csv_export(const char *directory, const char *out, const char *target,
+                                   int threads);
+
+/* Same as "transform in out mode [--pixels] --threads=threads"; mode is "crop" or "offset". */
+TFUTILS_API int tfutils_augment(const char *in, const char *out, const char *mode, int pixels,
+                                int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TFUTILS_LIBTFUTILS_H */
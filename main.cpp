@@ -8,18 +8,35 @@ private:
       "  mv a.txt b.txt                                                    \n"
       "  rm a.txt                                                          \n"
       "adb commands                                                        \n"
-      "  pull /sdcard [*.jpeg] [.]                                         \n"
-      "  remove /sdcard *.jpeg                                             \n"
+      "  pull /sdcard [*.jpeg] [.] [--resume] [--threads=N]                \n"
+      "  remove /sdcard *.jpeg [--threads=N]                               \n"
       "  cap [.]                                                           \n"
       "tensorflow commands                                                 \n"
-      "  convert InDirectory OutDirectory [224] [224]                      \n"
-      "  replace a.csv gs://                                               \n"
-      "  replaceobject a.csv name value                                    \n"
-      "  csv InDirectory a.csv [target]                                    \n"
-      "  transform [InDirectory|a.xml] [OutDirectory|b.xml] [crop|offset]  \n"
-      "  clone 0.xml 100 [1]                                               \n"
-      "  check [InDirectory|a.xml] [filename|name|path|size]               \n"
-      "  rotate [InDirectory|a.xml] name value                             \n";
+      "  convert InDirectory OutDirectory [224] [224] [--resume] [--threads=N]\n"
+      "  replace [a.csv|a.tfc] gs:// [--shards=N] [--threads=N]            \n"
+      "  replaceobject [a.csv|a.tfc] name value                            \n"
+      "  csv InDirectory a.csv [target] [--threads=N] [--watch|--shards=N] \n"
+      "  transform [InDirectory|a.xml] [OutDirectory|b.xml] [crop|offset] [--pixels]\n"
+      "            [--resume] [--threads=N]                                \n"
+      "  clone 0.xml 100 [1] [--resume]                                    \n"
+      "  check [InDirectory|a.xml|a.tfc] [filename|name|path|size] [--threads=N]\n"
+      "  check [InDirectory|a.xml|a.csv|a.tfc] stats [table|json] [--threads=N]\n"
+      "  rotate [InDirectory|a.xml] name value [--threads=N]               \n"
+      "  tfrecord InDirectory a.record [--shards=1] [--threads=N]          \n"
+      "  tfrecord-check [a.record|InDirectory|prefix] [--threads=N]        \n"
+      "  verify [InDirectory|a.xml] [--threads=N]                          \n"
+      "  dedup InDirectory [report|link|delete] [--threads=N]              \n"
+      "  lint [InDirectory|a.xml] [report|clamp|drop] [--threads=N]        \n"
+      "  dedupboxes [InDirectory|a.xml|a.csv] [0.9] [out.csv] [--threads=N]\n"
+      "  eval truth.csv predict.csv [0.5,0.75] [--curves=a.csv]            \n"
+      "  anchors [InDirectory|a.csv] [9] [kmeans|kmeans++] [--seed=0]      \n"
+      "  coco-export [InDirectory|a.csv] instances.json [--root=Images]    \n"
+      "  coco-import instances.json OutDirectory [--threads=N]             \n"
+      "  yolo InDirectory OutDirectory [--threads=N]                       \n"
+      "  columns [InDirectory|a.csv|a.tfc] [a.tfc|a.csv] [--threads=N]     \n"
+      "  merge out.csv a.csv b.csv... [--memory=1024] [--threads=N]        \n"
+      "  shuffle a.csv b.csv [--seed=0] [--memory=1024] [--threads=N]      \n"
+      "  pack InDirectory a.tar [gs://] [--split=MiB]                      \n";
 
 public:
   using tfutils::AbstractCommand::AbstractCommand;
@@ -49,6 +66,21 @@ constexpr Jchar COMMAND_TENSORFLOW_REPLACE[] = "replace";
 constexpr Jchar COMMAND_TENSORFLOW_CONVERT[] = "convert";
 constexpr Jchar COMMAND_TENSORFLOW_TRANSFORM[] = "transform";
 constexpr Jchar COMMAND_TENSORFLOW_REPLACE_OBJECT[] = "replaceobject";
+constexpr Jchar COMMAND_TENSORFLOW_RECORD[] = "tfrecord";
+constexpr Jchar COMMAND_TENSORFLOW_RECORD_CHECK[] = "tfrecord-check";
+constexpr Jchar COMMAND_TENSORFLOW_VERIFY[] = "verify";
+constexpr Jchar COMMAND_TENSORFLOW_DEDUP[] = "dedup";
+constexpr Jchar COMMAND_TENSORFLOW_LINT[] = "lint";
+constexpr Jchar COMMAND_TENSORFLOW_DEDUP_BOXES[] = "dedupboxes";
+constexpr Jchar COMMAND_TENSORFLOW_EVAL[] = "eval";
+constexpr Jchar COMMAND_TENSORFLOW_ANCHORS[] = "anchors";
+constexpr Jchar COMMAND_TENSORFLOW_COCO_EXPORT[] = "coco-export";
+constexpr Jchar COMMAND_TENSORFLOW_COCO_IMPORT[] = "coco-import";
+constexpr Jchar COMMAND_TENSORFLOW_YOLO[] = "yolo";
+constexpr Jchar COMMAND_TENSORFLOW_COLUMNS[] = "columns";
+constexpr Jchar COMMAND_TENSORFLOW_MERGE[] = "merge";
+constexpr Jchar COMMAND_TENSORFLOW_SHUFFLE[] = "shuffle";
+constexpr Jchar COMMAND_TENSORFLOW_PACK[] = "pack";
 
 Jint main(Jint argc, Jchar *args[]) {
   tfutils::CommandExecutor executor(argc, args);
@@ -71,5 +103,20 @@ Jint main(Jint argc, Jchar *args[]) {
   executor.add(new tfutils::TensorflowReplace(COMMAND_TENSORFLOW_REPLACE));
   executor.add(new tfutils::TensorflowTransform(COMMAND_TENSORFLOW_TRANSFORM));
   executor.add(new tfutils::TensorflowReplaceObject(COMMAND_TENSORFLOW_REPLACE_OBJECT));
+  executor.add(new tfutils::TensorflowRecord(COMMAND_TENSORFLOW_RECORD));
+  executor.add(new tfutils::TensorflowRecordCheck(COMMAND_TENSORFLOW_RECORD_CHECK));
+  executor.add(new tfutils::TensorflowVerify(COMMAND_TENSORFLOW_VERIFY));
+  executor.add(new tfutils::TensorflowDedup(COMMAND_TENSORFLOW_DEDUP));
+  executor.add(new tfutils::TensorflowLint(COMMAND_TENSORFLOW_LINT));
+  executor.add(new tfutils::TensorflowDedupBoxes(COMMAND_TENSORFLOW_DEDUP_BOXES));
+  executor.add(new tfutils::TensorflowEval(COMMAND_TENSORFLOW_EVAL));
+  executor.add(new tfutils::TensorflowAnchors(COMMAND_TENSORFLOW_ANCHORS));
+  executor.add(new tfutils::TensorflowCocoExport(COMMAND_TENSORFLOW_COCO_EXPORT));
+  executor.add(new tfutils::TensorflowCocoImport(COMMAND_TENSORFLOW_COCO_IMPORT));
+  executor.add(new tfutils::TensorflowYolo(COMMAND_TENSORFLOW_YOLO));
+  executor.add(new tfutils::TensorflowColumns(COMMAND_TENSORFLOW_COLUMNS));
+  executor.add(new tfutils::TensorflowMerge(COMMAND_TENSORFLOW_MERGE));
+  executor.add(new tfutils::TensorflowShuffle(COMMAND_TENSORFLOW_SHUFFLE));
+  executor.add(new tfutils::TensorflowPack(COMMAND_TENSORFLOW_PACK));
   return executor.execute();
 }
@@ -3,16 +3,47 @@
 
 namespace tfutils {
 
-using ICommandArgs = IBuffer<const Jchar *>;
+struct ICommandArgs : public IBuffer<const Jchar *> {
+  constexpr static Jchar OPTION_PREFIX[] = "--";
+  constexpr static Jchar OPTION_VALUE = '=';
+
+  static Jbool isOption(const Jchar *v) {
+    return (strncmp(v, OPTION_PREFIX, strlen(OPTION_PREFIX)) == 0) &&
+           (v[strlen(OPTION_PREFIX)] != 0x00);
+  }
+
+  virtual void pushOption(const Jchar *v) = 0;
+
+  virtual Jbool hasOption(const Jchar *v) = 0;
+
+  virtual const Jchar *getOption(const Jchar *v) = 0;
+};
 
 template <Jint Size> class CommandArgs : public ICommandArgs {
 private:
   Jint mArgsSize;
   Jint mArgsLength;
+  Jint mOptionsLength;
   const Jchar *mArgs[Size];
+  const Jchar *mOptions[Size];
+
+  const Jchar *findOption(const Jchar *v) {
+    Jint i = 0;
+    auto &&prefixLen = strlen(OPTION_PREFIX);
+    auto &&nameLen = strlen(v);
+
+    for (i = 0; i < this->mOptionsLength; ++i) {
+      auto &&option = &this->mOptions[i][prefixLen];
+      if (strncmp(option, v, nameLen) != 0)
+        continue;
+      if ((option[nameLen] == 0x00) || (option[nameLen] == OPTION_VALUE))
+        return &option[nameLen];
+    }
+    return nullptr;
+  }
 
 public:
-  CommandArgs() : mArgsSize(Size), mArgsLength(), mArgs() {}
+  CommandArgs() : mArgsSize(Size), mArgsLength(), mOptionsLength(), mArgs(), mOptions() {}
 
   void push(const Jchar *v) override {
     if (this->mArgsLength >= this->mArgsSize)
@@ -30,7 +61,27 @@ public:
 
   Jbool isEmpty() override { return (this->mArgsLength == 0); }
 
-  void clean() override { this->mArgsLength = 0; }
+  void clean() override {
+    this->mArgsLength = 0;
+    this->mOptionsLength = 0;
+  }
+
+  void pushOption(const Jchar *v) override {
+    if (this->mOptionsLength >= this->mArgsSize)
+      return;
+
+    this->mOptions[this->mOptionsLength] = v;
+    ++this->mOptionsLength;
+  }
+
+  Jbool hasOption(const Jchar *v) override { return (this->findOption(v) != nullptr); }
+
+  const Jchar *getOption(const Jchar *v) override {
+    auto &&ret = this->findOption(v);
+    if ((ret == nullptr) || (*ret != OPTION_VALUE))
+      return nullptr;
+    return (ret + 1);
+  }
 };
 
 class AbstractCommand {
@@ -82,8 +133,12 @@ public:
 
     auto &&name = this->mArgs[1];
     this->mCommandArgs->clean();
-    for (i = 2; i < this->mArgc; ++i)
-      this->mCommandArgs->push(this->mArgs[i]);
+    for (i = 2; i < this->mArgc; ++i) {
+      if (ICommandArgs::isOption(this->mArgs[i]))
+        this->mCommandArgs->pushOption(this->mArgs[i]);
+      else
+        this->mCommandArgs->push(this->mArgs[i]);
+    }
 
     for (auto &&command : this->mCommands) {
       if (strcmp(command->getName(), name) != 0)
@@ -7,8 +7,16 @@ class ADBPull : public AbstractCommand {
 private:
   constexpr static Jchar COMMAND_OUT[] = ".";
   constexpr static Jchar COMMAND_FROM[] = "*.*";
-  constexpr static Jchar COMMAND_GET_LIST[] = "adb shell ls %s/%s";
-  constexpr static Jchar COMMAND_PULL_LOCAL[] = "adb pull %s %s";
+  constexpr static Jchar OPTION_RESUME[] = "resume";
+  constexpr static Jchar JOURNAL_NAME[] = "pull";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar COMMAND_ADB[] = "adb";
+  constexpr static Jchar COMMAND_SHELL[] = "shell";
+  constexpr static Jchar COMMAND_LIST[] = "ls";
+  constexpr static Jchar COMMAND_PULL[] = "pull";
+  constexpr static Jchar FORMAT_REMOTE[] = "%s/%s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, pull failed";
+  constexpr static Jchar FORMAT_JOURNAL[] = "file: %s, journal open failed, progress is not saved";
 
 public:
   using AbstractCommand::AbstractCommand;
@@ -28,25 +36,54 @@ public:
     auto &&arg = (*v)[0];
     Log::info("ready to operate %s, format: %s, output: %s", arg, format, output);
 
-    auto &&get = String::format(COMMAND_GET_LIST, arg, format);
-    auto &&num = System(get);
+    // The device shell expands the pattern, so ls runs there and not through a local one.
+    auto &&remote = String::format(FORMAT_REMOTE, arg, format);
+    auto &&num = System(std::vector<std::string>{COMMAND_ADB, COMMAND_SHELL, COMMAND_LIST, remote});
     num.execute();
     auto &&all = num.getRows();
 
+    Journal journal(output, JOURNAL_NAME, v->hasOption(OPTION_RESUME));
+    if (!journal.isOpen())
+      Log::error(FORMAT_JOURNAL, journal.getPath().c_str());
+    std::vector<std::string> rows;
     auto &&prg = Program(all.size());
+    auto &&pool = ProcessPool(Parallel::getConcurrency(v->getOption(OPTION_THREADS)));
     for (auto row : all) {
-      auto &&mat = String::format(COMMAND_PULL_LOCAL, row.getRow().c_str(), output);
-      System(mat).execute();
-      prg.updateOne();
+      if (journal.isDone(row.getRow())) {
+        prg.updateOne();
+        continue;
+      }
+      rows.push_back(row.getRow());
+      pool.add({COMMAND_ADB, COMMAND_PULL, row.getRow(), output});
     }
+
+    pool.execute(
+        [](Jsize, const std::string &row, Jbool error) {
+          if (error)
+            fprintf(stderr, "%s\n", row.c_str());
+        },
+        [&](Jsize index, Jint status) {
+          auto &&local = std::filesystem::path(output) /
+                         std::filesystem::path(rows[index]).filename();
+          if ((status == 0) && File::isExist(local.string()))
+            journal.add(rows[index], {local.string()});
+          else
+            Log::error(FORMAT_FAILED, rows[index].c_str());
+          prg.updateOne();
+        });
     return 0;
   }
 };
 
 class ADBRemove : public AbstractCommand {
 private:
-  constexpr static Jchar COMMAND_GET_LIST[] = "adb shell ls %s/%s";
-  constexpr static Jchar COMMAND_REMOVE_LOCAL[] = "adb shell rm %s";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar COMMAND_ADB[] = "adb";
+  constexpr static Jchar COMMAND_SHELL[] = "shell";
+  constexpr static Jchar COMMAND_LIST[] = "ls";
+  constexpr static Jchar COMMAND_REMOVE[] = "rm";
+  constexpr static Jchar FORMAT_REMOTE[] = "%s/%s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, remove failed";
 
 public:
   using AbstractCommand::AbstractCommand;
@@ -59,17 +96,29 @@ public:
     auto &&format = (*v)[1];
     Log::info("ready to operate %s, format: %s", path, format);
 
-    auto &&get = String::format(COMMAND_GET_LIST, path, format);
-    auto &&num = System(get);
+    auto &&remote = String::format(FORMAT_REMOTE, path, format);
+    auto &&num = System(std::vector<std::string>{COMMAND_ADB, COMMAND_SHELL, COMMAND_LIST, remote});
     num.execute();
     auto &&all = num.getRows();
 
+    std::vector<std::string> rows;
     auto &&prg = Program(all.size());
+    auto &&pool = ProcessPool(Parallel::getConcurrency(v->getOption(OPTION_THREADS)));
     for (auto row : all) {
-      auto &&mat = String::format(COMMAND_REMOVE_LOCAL, row.getRow().data());
-      System(mat).execute();
-      prg.updateOne();
+      rows.push_back(row.getRow());
+      pool.add({COMMAND_ADB, COMMAND_SHELL, COMMAND_REMOVE, row.getRow()});
     }
+
+    pool.execute(
+        [](Jsize, const std::string &row, Jbool error) {
+          if (error)
+            fprintf(stderr, "%s\n", row.c_str());
+        },
+        [&](Jsize index, Jint status) {
+          if (status != 0)
+            Log::error(FORMAT_FAILED, rows[index].c_str());
+          prg.updateOne();
+        });
     return 0;
   }
 };
@@ -80,7 +129,11 @@ private:
 
   constexpr static Jchar COMMAND_PATH[] = "/sdcard";
   constexpr static Jchar COMMAND_FILE[] = "cap.png";
-  constexpr static Jchar COMMAND_SCREENCAP[] = "adb shell screencap -p %s/%s";
+  constexpr static Jchar COMMAND_ADB[] = "adb";
+  constexpr static Jchar COMMAND_SHELL[] = "shell";
+  constexpr static Jchar COMMAND_SCREENCAP[] = "screencap";
+  constexpr static Jchar COMMAND_PNG[] = "-p";
+  constexpr static Jchar FORMAT_REMOTE[] = "%s/%s";
 
   UP<ICommandArgs> mArgs;
 
@@ -102,8 +155,10 @@ public:
     if (v->getLength() == 1)
       this->mArgs->push((*v)[0]);
 
-    auto &&cmd = String::format(COMMAND_SCREENCAP, COMMAND_PATH, COMMAND_FILE);
-    System(cmd).execute();
+    auto &&remote = String::format(FORMAT_REMOTE, COMMAND_PATH, COMMAND_FILE);
+    System(std::vector<std::string>{COMMAND_ADB, COMMAND_SHELL, COMMAND_SCREENCAP, COMMAND_PNG,
+                                    remote})
+        .execute();
 
     executor = make<ADBPull>();
     executor->execute(this->mArgs);
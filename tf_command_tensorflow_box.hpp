@@ -0,0 +1,964 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_BOX_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_BOX_HPP
+
+namespace tfutils {
+
+using Jint4 = Jint __attribute__((vector_size(16)));
+using Jfloat4 = Jfloat __attribute__((vector_size(16)));
+
+enum LabelImageBoxFlag : Jint {
+  BOX_VALID = 0x00,
+  BOX_EMPTY = 0x01,
+  BOX_INVERTED = 0x02,
+  BOX_OUTSIDE = 0x04,
+};
+
+class LabelImageBoxBatch {
+private:
+  constexpr static Jsize LANES = sizeof(Jint4) / sizeof(Jint);
+
+  std::vector<Jint> mMinX;
+  std::vector<Jint> mMinY;
+  std::vector<Jint> mMaxX;
+  std::vector<Jint> mMaxY;
+  std::vector<Jint> mWidth;
+  std::vector<Jint> mHeight;
+  std::vector<Jint> mFlags;
+
+  static Jint4 load(const std::vector<Jint> &v, Jsize i) {
+    Jint4 ret;
+    memcpy(&ret, &v[i], sizeof(ret));
+    return ret;
+  }
+
+public:
+  LabelImageBoxBatch()
+      : mMinX(), mMinY(), mMaxX(), mMaxY(), mWidth(), mHeight(), mFlags() {}
+
+  void clean() {
+    this->mMinX.clear();
+    this->mMinY.clear();
+    this->mMaxX.clear();
+    this->mMaxY.clear();
+    this->mWidth.clear();
+    this->mHeight.clear();
+    this->mFlags.clear();
+  }
+
+  void add(const LabelImageXMLBndbox &box, const LabelImageXMLSize &size) {
+    this->mMinX.push_back(box.getMinX());
+    this->mMinY.push_back(box.getMinY());
+    this->mMaxX.push_back(box.getMaxX());
+    this->mMaxY.push_back(box.getMaxY());
+    this->mWidth.push_back(size.getWidth());
+    this->mHeight.push_back(size.getHeight());
+  }
+
+  [[nodiscard]] Jsize getSize() const { return this->mMinX.size(); }
+
+  [[nodiscard]] Jint getFlag(Jsize i) const { return this->mFlags[i]; }
+
+  void validate() {
+    Jsize i = 0;
+    Jint4 zero = {0, 0, 0, 0};
+    Jint4 empty = {BOX_EMPTY, BOX_EMPTY, BOX_EMPTY, BOX_EMPTY};
+    Jint4 inverted = {BOX_INVERTED, BOX_INVERTED, BOX_INVERTED, BOX_INVERTED};
+    Jint4 outside = {BOX_OUTSIDE, BOX_OUTSIDE, BOX_OUTSIDE, BOX_OUTSIDE};
+
+    auto &&count = this->getSize();
+    auto &&padded = (count + LANES - 1) / LANES * LANES;
+    for (auto &&column : {&this->mMinX, &this->mMinY, &this->mMaxX, &this->mMaxY, &this->mWidth,
+                          &this->mHeight})
+      column->resize(padded);
+    this->mFlags.resize(padded);
+
+    for (i = 0; i < padded; i += LANES) {
+      auto &&minX = load(this->mMinX, i);
+      auto &&minY = load(this->mMinY, i);
+      auto &&maxX = load(this->mMaxX, i);
+      auto &&maxY = load(this->mMaxY, i);
+      auto &&width = load(this->mWidth, i);
+      auto &&height = load(this->mHeight, i);
+
+      auto &&isEmpty = (minX == maxX) | (minY == maxY);
+      auto &&isInverted = (minX > maxX) | (minY > maxY);
+      auto &&isSized = (width > zero) & (height > zero);
+      auto &&isNegative = (minX < zero) | (minY < zero) | (maxX < zero) | (maxY < zero);
+      auto &&isOver = (minX > width) | (minY > height) | (maxX > width) | (maxY > height);
+      auto &&isOutside = isSized & (isNegative | isOver);
+
+      Jint4 flags = (isEmpty & empty) | (isInverted & inverted) | (isOutside & outside);
+      memcpy(&this->mFlags[i], &flags, sizeof(flags));
+    }
+
+    for (auto &&column : {&this->mMinX, &this->mMinY, &this->mMaxX, &this->mMaxY, &this->mWidth,
+                          &this->mHeight, &this->mFlags})
+      column->resize(count);
+  }
+};
+
+class LabelImageBoxKernel {
+public:
+  constexpr static Jsize LANES = sizeof(Jfloat4) / sizeof(Jfloat);
+
+  static Jsize getPadded(Jsize v) { return (v + LANES - 1) / LANES * LANES; }
+
+  // columns must be readable up to getPadded(count), out must hold as many values
+  static void iou(const Jfloat *minX, const Jfloat *minY, const Jfloat *maxX, const Jfloat *maxY,
+                  Jsize count, Jfloat x1, Jfloat y1, Jfloat x2, Jfloat y2, Jfloat *out) {
+    Jsize i = 0;
+    Jfloat4 keptMinX;
+    Jfloat4 keptMinY;
+    Jfloat4 keptMaxX;
+    Jfloat4 keptMaxY;
+
+    auto &&zero = Jfloat4{};
+    auto &&boxMinX = zero + x1;
+    auto &&boxMinY = zero + y1;
+    auto &&boxMaxX = zero + x2;
+    auto &&boxMaxY = zero + y2;
+    auto &&area = (boxMaxX - boxMinX) * (boxMaxY - boxMinY);
+
+    for (i = 0; i < count; i += LANES) {
+      memcpy(&keptMinX, &minX[i], sizeof(keptMinX));
+      memcpy(&keptMinY, &minY[i], sizeof(keptMinY));
+      memcpy(&keptMaxX, &maxX[i], sizeof(keptMaxX));
+      memcpy(&keptMaxY, &maxY[i], sizeof(keptMaxY));
+
+      auto &&w = (boxMaxX < keptMaxX ? boxMaxX : keptMaxX) -
+                 (boxMinX > keptMinX ? boxMinX : keptMinX);
+      auto &&h = (boxMaxY < keptMaxY ? boxMaxY : keptMaxY) -
+                 (boxMinY > keptMinY ? boxMinY : keptMinY);
+      auto &&inter = (w > zero ? w : zero) * (h > zero ? h : zero);
+      auto &&uni = area + (keptMaxX - keptMinX) * (keptMaxY - keptMinY) - inter;
+
+      Jfloat4 ret = (uni > zero) ? (inter / uni) : zero;
+      memcpy(&out[i], &ret, sizeof(ret));
+    }
+  }
+
+  // every lane up to getPadded(count) is written, anchors are shared by all lanes
+  static void assign(const Jfloat *width, const Jfloat *height, Jsize count,
+                     const std::vector<Jfloat> &anchorWidth,
+                     const std::vector<Jfloat> &anchorHeight, Jint *best, Jfloat *bestIou) {
+    Jsize i = 0;
+    Jsize k = 0;
+    Jfloat4 boxWidth;
+    Jfloat4 boxHeight;
+
+    auto &&zero = Jfloat4{};
+    for (i = 0; i < count; i += LANES) {
+      memcpy(&boxWidth, &width[i], sizeof(boxWidth));
+      memcpy(&boxHeight, &height[i], sizeof(boxHeight));
+
+      auto &&area = boxWidth * boxHeight;
+      auto &&index = Jint4{};
+      auto &&value = zero - 1;
+      for (k = 0; k < anchorWidth.size(); ++k) {
+        auto &&w = zero + anchorWidth[k];
+        auto &&h = zero + anchorHeight[k];
+        auto &&inter = (boxWidth < w ? boxWidth : w) * (boxHeight < h ? boxHeight : h);
+        auto &&uni = area + w * h - inter;
+        Jfloat4 iou = (uni > zero) ? (inter / uni) : zero;
+
+        auto &&better = iou > value;
+        value = better ? iou : value;
+        index = better ? (Jint4{} + static_cast<Jint>(k)) : index;
+      }
+
+      memcpy(&best[i], &index, sizeof(index));
+      memcpy(&bestIou[i], &value, sizeof(value));
+    }
+  }
+};
+
+class LabelImageBoxIndex {
+private:
+  constexpr static Jint SIZE_GRID = 8;
+
+  Jfloat mWidth;
+  Jfloat mHeight;
+  Jint mStamp;
+
+  std::vector<Jint> mLabels;
+  std::vector<Jfloat> mMinX;
+  std::vector<Jfloat> mMinY;
+  std::vector<Jfloat> mMaxX;
+  std::vector<Jfloat> mMaxY;
+  std::vector<Jint> mStamps;
+  std::vector<std::vector<Jint>> mCells;
+
+  std::vector<Jfloat> mCandidateMinX;
+  std::vector<Jfloat> mCandidateMinY;
+  std::vector<Jfloat> mCandidateMaxX;
+  std::vector<Jfloat> mCandidateMaxY;
+  std::vector<Jfloat> mIous;
+
+  Jint cell(Jfloat v, Jfloat extent) const {
+    auto &&ret = static_cast<Jint>(v / extent * SIZE_GRID);
+    return std::clamp(ret, 0, SIZE_GRID - 1);
+  }
+
+  Jbool overlaps(Jfloat x1, Jfloat y1, Jfloat x2, Jfloat y2, Jfloat threshold) {
+    auto &&count = this->mCandidateMinX.size();
+    auto &&padded = LabelImageBoxKernel::getPadded(count);
+
+    for (auto &&column : {&this->mCandidateMinX, &this->mCandidateMinY, &this->mCandidateMaxX,
+                          &this->mCandidateMaxY, &this->mIous})
+      column->resize(padded);
+
+    LabelImageBoxKernel::iou(this->mCandidateMinX.data(), this->mCandidateMinY.data(),
+                             this->mCandidateMaxX.data(), this->mCandidateMaxY.data(), count, x1,
+                             y1, x2, y2, this->mIous.data());
+    return std::any_of(this->mIous.begin(), this->mIous.begin() + count,
+                       [threshold](Jfloat v) { return v > threshold; });
+  }
+
+public:
+  LabelImageBoxIndex()
+      : mWidth(), mHeight(), mStamp(), mLabels(), mMinX(), mMinY(), mMaxX(), mMaxY(), mStamps(),
+        mCells(SIZE_GRID * SIZE_GRID), mCandidateMinX(), mCandidateMinY(), mCandidateMaxX(),
+        mCandidateMaxY(), mIous() {}
+
+  void clean(Jfloat width, Jfloat height) {
+    this->mWidth = (width > 0) ? width : 1;
+    this->mHeight = (height > 0) ? height : 1;
+    this->mLabels.clear();
+    this->mMinX.clear();
+    this->mMinY.clear();
+    this->mMaxX.clear();
+    this->mMaxY.clear();
+    this->mStamps.clear();
+    for (auto &&one : this->mCells)
+      one.clear();
+  }
+
+  Jbool insert(Jint label, Jfloat x1, Jfloat y1, Jfloat x2, Jfloat y2, Jfloat threshold) {
+    Jint x = 0;
+    Jint y = 0;
+
+    auto minX = std::min(x1, x2);
+    auto minY = std::min(y1, y2);
+    auto maxX = std::max(x1, x2);
+    auto maxY = std::max(y1, y2);
+    auto &&left = this->cell(minX, this->mWidth);
+    auto &&top = this->cell(minY, this->mHeight);
+    auto &&right = this->cell(maxX, this->mWidth);
+    auto &&bottom = this->cell(maxY, this->mHeight);
+
+    ++this->mStamp;
+    this->mCandidateMinX.clear();
+    this->mCandidateMinY.clear();
+    this->mCandidateMaxX.clear();
+    this->mCandidateMaxY.clear();
+    for (y = top; y <= bottom; ++y) {
+      for (x = left; x <= right; ++x) {
+        for (auto &&kept : this->mCells[y * SIZE_GRID + x]) {
+          if ((this->mLabels[kept] != label) || (this->mStamps[kept] == this->mStamp))
+            continue;
+          this->mStamps[kept] = this->mStamp;
+          this->mCandidateMinX.push_back(this->mMinX[kept]);
+          this->mCandidateMinY.push_back(this->mMinY[kept]);
+          this->mCandidateMaxX.push_back(this->mMaxX[kept]);
+          this->mCandidateMaxY.push_back(this->mMaxY[kept]);
+        }
+      }
+    }
+
+    if (this->overlaps(minX, minY, maxX, maxY, threshold))
+      return false;
+
+    auto &&index = static_cast<Jint>(this->mLabels.size());
+    this->mLabels.push_back(label);
+    this->mMinX.push_back(minX);
+    this->mMinY.push_back(minY);
+    this->mMaxX.push_back(maxX);
+    this->mMaxY.push_back(maxY);
+    this->mStamps.push_back(this->mStamp);
+    for (y = top; y <= bottom; ++y) {
+      for (x = left; x <= right; ++x)
+        this->mCells[y * SIZE_GRID + x].push_back(index);
+    }
+    return true;
+  }
+};
+
+class TensorflowLint : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_BLOCK = 32;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar MODEL_REPORT[] = "report";
+  constexpr static Jchar MODEL_CLAMP[] = "clamp";
+  constexpr static Jchar MODEL_DROP[] = "drop";
+
+  constexpr static Jchar REASON_EMPTY[] = "empty";
+  constexpr static Jchar REASON_INVERTED[] = "inverted";
+  constexpr static Jchar REASON_OUTSIDE[] = "outside";
+
+  constexpr static Jchar FORMAT_BNDBOX[] = "file: %s-%s-%s (%d,%d,%d,%d) %s";
+  constexpr static Jchar FORMAT_UNREADABLE[] = "file: %s, unreadable";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, unreadable: %d, boxes: %lld, empty: %lld, "
+                                         "inverted: %lld, outside: %lld, rewritten: %d";
+
+  class Summary {
+  public:
+    Jint mUnreadable;
+    Jlong mBoxes;
+    Jlong mEmpty;
+    Jlong mInverted;
+    Jlong mOutside;
+    Jint mRewritten;
+    std::vector<std::pair<Jsize, std::string>> mResults;
+
+    Summary()
+        : mUnreadable(), mBoxes(), mEmpty(), mInverted(), mOutside(), mRewritten(), mResults() {}
+  };
+
+  static std::string reason(Jint flag) {
+    std::string ret;
+
+    for (auto &&kv : {std::make_pair(BOX_EMPTY, REASON_EMPTY),
+                      std::make_pair(BOX_INVERTED, REASON_INVERTED),
+                      std::make_pair(BOX_OUTSIDE, REASON_OUTSIDE)}) {
+      if ((flag & kv.first) == 0)
+        continue;
+      if (!ret.empty())
+        ret.push_back('|');
+      ret.append(kv.second);
+    }
+    return ret;
+  }
+
+  static Jbool clamp(LabelImageXMLObject &object, const LabelImageXMLSize &size) {
+    auto box = object.getBndbox();
+    auto width = (size.getWidth() > 0) ? size.getWidth() : INT32_MAX;
+    auto height = (size.getHeight() > 0) ? size.getHeight() : INT32_MAX;
+
+    auto minX = std::min(box.getMinX(), box.getMaxX());
+    auto maxX = std::max(box.getMinX(), box.getMaxX());
+    auto minY = std::min(box.getMinY(), box.getMaxY());
+    auto maxY = std::max(box.getMinY(), box.getMaxY());
+
+    box.setMinX(std::clamp(minX, 0, width));
+    box.setMaxX(std::clamp(maxX, 0, width));
+    box.setMinY(std::clamp(minY, 0, height));
+    box.setMaxY(std::clamp(maxY, 0, height));
+    object.setBndbox(box);
+    return (box.getMinX() < box.getMaxX()) && (box.getMinY() < box.getMaxY());
+  }
+
+  static void lint(const std::vector<std::string> &paths, const std::vector<std::string> &names,
+                   Jsize block, const std::string &model, LabelImageBoxBatch &batch,
+                   Summary &summary) {
+    Jsize j = 0;
+    std::vector<SP<LabelImageXML>> xmls;
+
+    auto &&begin = block * SIZE_BLOCK;
+    auto end = std::min(paths.size(), begin + SIZE_BLOCK);
+
+    batch.clean();
+    for (auto i = begin; i < end; ++i) {
+      xmls.emplace_back(new LabelImageXML(paths[i]));
+      for (auto &&object : xmls.back()->getObjects())
+        batch.add(object.getBndbox(), xmls.back()->getSize());
+    }
+    batch.validate();
+
+    for (auto i = begin; i < end; ++i) {
+      Jbool dirty = false;
+      auto &&xml = xmls[i - begin];
+      auto &&objects = xml->getObjects();
+      if (!xml->isParsed()) {
+        ++summary.mUnreadable;
+        summary.mResults.emplace_back(i, String::format(FORMAT_UNREADABLE, names[i].c_str()));
+        continue;
+      }
+
+      for (auto it = objects.begin(); it != objects.end(); ++j) {
+        auto &&flag = batch.getFlag(j);
+        auto &&box = it->getBndbox();
+
+        ++summary.mBoxes;
+        if (flag == BOX_VALID) {
+          ++it;
+          continue;
+        }
+
+        summary.mEmpty += ((flag & BOX_EMPTY) != 0);
+        summary.mInverted += ((flag & BOX_INVERTED) != 0);
+        summary.mOutside += ((flag & BOX_OUTSIDE) != 0);
+        summary.mResults.emplace_back(
+            i, String::format(FORMAT_BNDBOX, names[i].c_str(), LabelImageXMLTarget::O_BNDBOX,
+                              it->getName().c_str(), box.getMinX(), box.getMinY(),
+                              box.getMaxX(), box.getMaxY(), reason(flag).c_str()));
+
+        if (model == MODEL_REPORT) {
+          ++it;
+          continue;
+        }
+
+        dirty = true;
+        if ((model == MODEL_DROP) || (!clamp(*it, xml->getSize())))
+          it = objects.erase(it);
+        else
+          ++it;
+      }
+
+      if (!dirty)
+        continue;
+      LabelImageXMLExporter(xml, paths[i]).exported();
+      ++summary.mRewritten;
+    }
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Summary all;
+    std::string model = MODEL_REPORT;
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 1)
+      return -1;
+    if (v->getLength() > 1)
+      model = (*v)[1];
+    if ((model != MODEL_REPORT) && (model != MODEL_CLAMP) && (model != MODEL_DROP))
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+      names.push_back(in.filename().string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in)) {
+        paths.push_back(one->getAbstractPath());
+        names.push_back(one->getName());
+      }
+    }
+
+    auto &&blocks = (paths.size() + SIZE_BLOCK - 1) / SIZE_BLOCK;
+    auto &&batches = std::vector<LabelImageBoxBatch>(threads);
+    auto &&summaries = std::vector<Summary>(threads);
+    auto &&prog = Program(blocks);
+    Parallel::forEach(threads, blocks, [&](Jsize block, Jint worker) {
+      lint(paths, names, block, model, batches[worker], summaries[worker]);
+      prog.updateOne();
+    });
+
+    for (auto &&summary : summaries) {
+      all.mUnreadable += summary.mUnreadable;
+      all.mBoxes += summary.mBoxes;
+      all.mEmpty += summary.mEmpty;
+      all.mInverted += summary.mInverted;
+      all.mOutside += summary.mOutside;
+      all.mRewritten += summary.mRewritten;
+      all.mResults.insert(all.mResults.end(), summary.mResults.begin(), summary.mResults.end());
+    }
+
+    std::stable_sort(all.mResults.begin(), all.mResults.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (auto &&result : all.mResults)
+      Log::error(result.second);
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(paths.size()), all.mUnreadable, all.mBoxes,
+              all.mEmpty, all.mInverted, all.mOutside, all.mRewritten);
+    return 0;
+  }
+};
+
+class TensorflowDedupBoxes : public AbstractCommand {
+private:
+  constexpr static Jfloat THRESHOLD = 0.9f;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, write failed";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, boxes: %lld, removed: %lld";
+
+  class Row {
+  public:
+    std::string_view mLine;
+    std::string_view mPath;
+    std::string_view mLabel;
+    Jfloat mMinX;
+    Jfloat mMinY;
+    Jfloat mMaxX;
+    Jfloat mMaxY;
+    Jbool mValid;
+    Jbool mKept;
+
+    Row() : mLine(), mPath(), mLabel(), mMinX(), mMinY(), mMaxX(), mMaxY(), mValid(), mKept(true) {}
+  };
+
+  static Jint label(std::vector<std::string_view> &labels, std::string_view v) {
+    auto &&it = std::find(labels.begin(), labels.end(), v);
+    if (it != labels.end())
+      return static_cast<Jint>(it - labels.begin());
+    labels.push_back(v);
+    return static_cast<Jint>(labels.size() - 1);
+  }
+
+  static void xml(const std::string &path, Jfloat threshold, LabelImageBoxIndex &index,
+                  Jlong &boxes, Jlong &removed) {
+    Jint count = 0;
+    Jint width = 0;
+    Jint height = 0;
+    std::vector<std::string_view> labels;
+
+    auto &&xml = SP<LabelImageXML>(new LabelImageXML(path));
+    auto &&objects = xml->getObjects();
+
+    width = xml->getSize().getWidth();
+    height = xml->getSize().getHeight();
+    for (auto &&object : objects) {
+      width = std::max({width, object.getBndbox().getMinX(), object.getBndbox().getMaxX()});
+      height = std::max({height, object.getBndbox().getMinY(), object.getBndbox().getMaxY()});
+    }
+
+    index.clean(static_cast<Jfloat>(width), static_cast<Jfloat>(height));
+    for (auto it = objects.begin(); it != objects.end();) {
+      auto &&box = it->getBndbox();
+      if (index.insert(label(labels, it->getName()), static_cast<Jfloat>(box.getMinX()),
+                       static_cast<Jfloat>(box.getMinY()), static_cast<Jfloat>(box.getMaxX()),
+                       static_cast<Jfloat>(box.getMaxY()), threshold)) {
+        ++it;
+        continue;
+      }
+
+      it = objects.erase(it);
+      ++count;
+    }
+
+    boxes += static_cast<Jlong>(objects.size()) + count;
+    removed += count;
+    if (count != 0)
+      LabelImageXMLExporter(xml, path).exported();
+  }
+
+  static Jbool csv(const std::string &in, const std::string &out, Jfloat threshold, Jint threads,
+                   Jlong &boxes, Jlong &removed) {
+    std::vector<Row> rows;
+    std::vector<Jsize> order;
+    std::vector<std::pair<Jsize, Jsize>> groups;
+
+    auto &&file = InputFile(in);
+    if (!file.isOpen())
+      return false;
+
+    file.forEachLine([&rows](std::string_view line) {
+      rows.emplace_back();
+      rows.back().mLine = line;
+    });
+
+    auto &&buffers = std::vector<std::string>(threads);
+    Parallel::forEach(threads, rows.size(), [&](Jsize i, Jint worker) {
+      TFCSVRow row;
+      auto &&one = rows[i];
+      if (!TFCSV::parseLine(one.mLine, row, buffers[worker]))
+        return;
+
+      one.mValid = true;
+      one.mPath = TFCSV::field(one.mLine, 1);
+      one.mLabel = TFCSV::field(one.mLine, 2);
+      one.mMinX = row.getX1();
+      one.mMinY = row.getY1();
+      one.mMaxX = row.getX3();
+      one.mMaxY = row.getY3();
+    });
+
+    for (Jsize i = 0; i < rows.size(); ++i) {
+      if (rows[i].mValid)
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&rows](Jsize a, Jsize b) { return rows[a].mPath < rows[b].mPath; });
+    for (Jsize i = 0; i < order.size(); ++i) {
+      if ((i == 0) || (rows[order[i]].mPath != rows[order[i - 1]].mPath))
+        groups.emplace_back(i, i);
+      groups.back().second = i + 1;
+    }
+
+    auto &&indexes = std::vector<LabelImageBoxIndex>(threads);
+    Parallel::forEach(threads, groups.size(), [&](Jsize group, Jint worker) {
+      std::vector<std::string_view> labels;
+      auto &&index = indexes[worker];
+
+      index.clean(1, 1);
+      for (auto i = groups[group].first; i < groups[group].second; ++i) {
+        auto &&one = rows[order[i]];
+        one.mKept = index.insert(label(labels, one.mLabel), one.mMinX, one.mMinY, one.mMaxX,
+                                 one.mMaxY, threshold);
+      }
+    });
+
+    auto &&temp = out + SURRFIX_TEMP;
+    auto &&output = OutputFile(temp, Gzip::isGzip(out), MODEL_WRITER_ONLY, threads);
+    if (!output.isOpen())
+      return false;
+
+    for (auto &&one : rows) {
+      boxes += one.mValid;
+      if (!one.mKept) {
+        ++removed;
+        continue;
+      }
+      output.write(one.mLine);
+      output.write("\n", 1);
+    }
+
+    if (output.close() && (rename(temp.c_str(), out.c_str()) == 0))
+      return true;
+
+    File::remove(temp);
+    return false;
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jlong boxes = 0;
+    Jlong removed = 0;
+    Jfloat threshold = THRESHOLD;
+    std::vector<std::string> paths;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 1)
+      return -1;
+    if (v->getLength() > 1)
+      threshold = std::strtof((*v)[1], nullptr);
+    if ((threshold <= 0) || (threshold > 1))
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    if (Gzip::getExtension(in) == SURRFIX_CSV) {
+      auto &&out = (v->getLength() > 2) ? std::string((*v)[2]) : in.string();
+      if (!csv(in.string(), out, threshold, threads, boxes, removed)) {
+        Log::error(FORMAT_FAILED, out.c_str());
+        return 0;
+      }
+
+      Log::info(FORMAT_DONE, 1, boxes, removed);
+      return 0;
+    }
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in))
+        paths.push_back(one->getAbstractPath());
+    }
+
+    auto &&indexes = std::vector<LabelImageBoxIndex>(threads);
+    auto &&counts = std::vector<std::pair<Jlong, Jlong>>(threads);
+    auto &&prog = Program(paths.size());
+    Parallel::forEach(threads, paths.size(), [&](Jsize i, Jint worker) {
+      xml(paths[i], threshold, indexes[worker], counts[worker].first, counts[worker].second);
+      prog.updateOne();
+    });
+
+    for (auto &&count : counts) {
+      boxes += count.first;
+      removed += count.second;
+    }
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(paths.size()), boxes, removed);
+    return 0;
+  }
+};
+
+class TensorflowAnchors : public AbstractCommand {
+private:
+  constexpr static Jint SIZE_ANCHORS = 9;
+  constexpr static Jint SIZE_ITERATIONS = 300;
+  constexpr static Jsize SIZE_CHUNK = 64 * 1024;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar OPTION_ITERATIONS[] = "iterations";
+  constexpr static Jchar OPTION_SEED[] = "seed";
+
+  constexpr static Jchar MODEL_KMEANS[] = "kmeans";
+  constexpr static Jchar MODEL_KMEANS_PLUS[] = "kmeans++";
+
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, read failed";
+  constexpr static Jchar FORMAT_ANCHOR[] = "anchor: %d, width: %.6f, height: %.6f, boxes: %lld";
+  constexpr static Jchar FORMAT_DONE[] = "anchors: %d, boxes: %lld, iterations: %d, mean IoU: %.6f";
+
+  class Cluster {
+  public:
+    std::vector<Jdouble> mWidth;
+    std::vector<Jdouble> mHeight;
+    std::vector<Jlong> mCount;
+    Jdouble mIou;
+    Jlong mChanged;
+
+    Cluster() : mWidth(), mHeight(), mCount(), mIou(), mChanged() {}
+
+    void clean(Jsize k) {
+      this->mWidth.assign(k, 0);
+      this->mHeight.assign(k, 0);
+      this->mCount.assign(k, 0);
+      this->mIou = 0;
+      this->mChanged = 0;
+    }
+  };
+
+  Jsize mCount;
+  std::vector<Jfloat> mWidth;
+  std::vector<Jfloat> mHeight;
+  std::vector<Jint> mAssigned;
+  std::vector<Jfloat> mIous;
+
+  void add(std::vector<std::vector<Jfloat>> &width, std::vector<std::vector<Jfloat>> &height) {
+    std::vector<std::pair<Jfloat, Jfloat>> boxes;
+
+    for (Jsize i = 0; i < width.size(); ++i) {
+      for (Jsize j = 0; j < width[i].size(); ++j)
+        boxes.emplace_back(width[i][j], height[i][j]);
+      width[i] = std::vector<Jfloat>();
+      height[i] = std::vector<Jfloat>();
+    }
+
+    std::sort(boxes.begin(), boxes.end());
+    for (auto &&box : boxes) {
+      this->mWidth.push_back(box.first);
+      this->mHeight.push_back(box.second);
+    }
+  }
+
+  void loadXml(const std::filesystem::path &in, Jint threads) {
+    std::vector<std::string> paths;
+    UP<File> file(new File());
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in))
+        paths.push_back(one->getAbstractPath());
+    }
+
+    auto &&width = std::vector<std::vector<Jfloat>>(threads);
+    auto &&height = std::vector<std::vector<Jfloat>>(threads);
+    Parallel::forEach(threads, paths.size(), [&](Jsize i, Jint worker) {
+      auto &&xml = LabelImageXML(paths[i]);
+      auto &&size = xml.getSize();
+      if ((size.getWidth() <= 0) || (size.getHeight() <= 0))
+        return;
+
+      for (auto &&object : xml.getObjects()) {
+        auto &&box = object.getBndbox();
+        auto &&w = static_cast<Jfloat>(std::abs(box.getMaxX() - box.getMinX()));
+        auto &&h = static_cast<Jfloat>(std::abs(box.getMaxY() - box.getMinY()));
+        if ((w <= 0) || (h <= 0))
+          continue;
+        width[worker].push_back(w / static_cast<Jfloat>(size.getWidth()));
+        height[worker].push_back(h / static_cast<Jfloat>(size.getHeight()));
+      }
+    });
+    this->add(width, height);
+  }
+
+  Jbool loadCsv(const std::string &in, Jint threads) {
+    auto &&buffers = std::vector<std::string>(threads);
+    auto &&width = std::vector<std::vector<Jfloat>>(threads);
+    auto &&height = std::vector<std::vector<Jfloat>>(threads);
+    auto &&ret = TFCSV::forEachLine(in, threads, [&](std::string_view line, Jint worker) {
+      TFCSVRow row;
+      if (!TFCSV::parseLine(line, row, buffers[worker]))
+        return;
+
+      auto &&w = std::abs(row.getX3() - row.getX1());
+      auto &&h = std::abs(row.getY3() - row.getY1());
+      if ((w <= 0) || (h <= 0))
+        return;
+      width[worker].push_back(w);
+      height[worker].push_back(h);
+    });
+    this->add(width, height);
+    return ret;
+  }
+
+  void assign(Jint threads, const std::vector<Jfloat> &anchorWidth,
+              const std::vector<Jfloat> &anchorHeight, std::vector<Cluster> &clusters) {
+    auto &&count = this->mCount;
+    auto &&chunks = (count + SIZE_CHUNK - 1) / SIZE_CHUNK;
+    auto &&best = std::vector<std::vector<Jint>>(threads);
+
+    for (auto &&cluster : clusters)
+      cluster.clean(anchorWidth.size());
+
+    Parallel::forEach(threads, chunks, [&](Jsize chunk, Jint worker) {
+      auto &&begin = chunk * SIZE_CHUNK;
+      auto end = std::min(count, begin + SIZE_CHUNK);
+      auto &&cluster = clusters[worker];
+      auto &&assigned = best[worker];
+
+      assigned.resize(LabelImageBoxKernel::getPadded(SIZE_CHUNK));
+      LabelImageBoxKernel::assign(&this->mWidth[begin], &this->mHeight[begin], end - begin,
+                                  anchorWidth, anchorHeight, assigned.data(),
+                                  &this->mIous[begin]);
+      for (auto i = begin; i < end; ++i) {
+        auto &&k = assigned[i - begin];
+        cluster.mChanged += (this->mAssigned[i] != k);
+        this->mAssigned[i] = k;
+        cluster.mWidth[k] += this->mWidth[i];
+        cluster.mHeight[k] += this->mHeight[i];
+        cluster.mCount[k] += 1;
+        cluster.mIou += this->mIous[i];
+      }
+    });
+
+    for (Jsize i = 1; i < clusters.size(); ++i) {
+      for (Jsize k = 0; k < anchorWidth.size(); ++k) {
+        clusters[0].mWidth[k] += clusters[i].mWidth[k];
+        clusters[0].mHeight[k] += clusters[i].mHeight[k];
+        clusters[0].mCount[k] += clusters[i].mCount[k];
+      }
+      clusters[0].mIou += clusters[i].mIou;
+      clusters[0].mChanged += clusters[i].mChanged;
+    }
+  }
+
+  void seed(Jint threads, Jint k, const std::string &model, std::mt19937_64 &random,
+            std::vector<Jfloat> &anchorWidth, std::vector<Jfloat> &anchorHeight) {
+    std::vector<Cluster> clusters(threads);
+    std::uniform_int_distribution<Jsize> uniform(0, this->mCount - 1);
+
+    auto &&first = uniform(random);
+    anchorWidth.push_back(this->mWidth[first]);
+    anchorHeight.push_back(this->mHeight[first]);
+
+    while (static_cast<Jint>(anchorWidth.size()) < k) {
+      Jsize chosen = uniform(random);
+
+      if (model == MODEL_KMEANS_PLUS) {
+        Jdouble total = 0;
+
+        this->assign(threads, anchorWidth, anchorHeight, clusters);
+        for (Jsize i = 0; i < this->mCount; ++i)
+          total += 1.0 - this->mIous[i];
+
+        auto &&target = std::uniform_real_distribution<Jdouble>(0, total)(random);
+        for (Jsize i = 0; i < this->mCount; ++i) {
+          target -= 1.0 - this->mIous[i];
+          chosen = i;
+          if (target <= 0)
+            break;
+        }
+      }
+
+      anchorWidth.push_back(this->mWidth[chosen]);
+      anchorHeight.push_back(this->mHeight[chosen]);
+    }
+  }
+
+public:
+  explicit TensorflowAnchors(const Jchar *v)
+      : AbstractCommand(v), mCount(), mWidth(), mHeight(), mAssigned(), mIous() {}
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jint i = 0;
+    Jint k = SIZE_ANCHORS;
+    Jint iterations = SIZE_ITERATIONS;
+    Juint seed = 0;
+    std::string model = MODEL_KMEANS_PLUS;
+    std::vector<Jfloat> anchorWidth;
+    std::vector<Jfloat> anchorHeight;
+
+    if (v->getLength() < 1)
+      return -1;
+    if (v->getLength() > 1)
+      k = static_cast<Jint>(std::strtol((*v)[1], nullptr, 10));
+    if (v->getLength() > 2)
+      model = (*v)[2];
+    if (v->getOption(OPTION_ITERATIONS) != nullptr)
+      iterations = static_cast<Jint>(std::strtol(v->getOption(OPTION_ITERATIONS), nullptr, 10));
+    if (v->getOption(OPTION_SEED) != nullptr)
+      seed = static_cast<Juint>(std::strtoul(v->getOption(OPTION_SEED), nullptr, 10));
+    if ((k < 1) || (iterations < 1))
+      return -1;
+    if ((model != MODEL_KMEANS) && (model != MODEL_KMEANS_PLUS))
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    auto &&random = std::mt19937_64(seed);
+    auto &&clusters = std::vector<Cluster>(threads);
+
+    if (Gzip::getExtension(in) == SURRFIX_CSV) {
+      if (!this->loadCsv(in.string(), threads)) {
+        Log::error(FORMAT_FAILED, in.string().c_str());
+        return -1;
+      }
+    } else {
+      this->loadXml(in, threads);
+    }
+    if (this->mWidth.size() < static_cast<Jsize>(k))
+      return -1;
+
+    auto &&count = this->mWidth.size();
+    auto &&padded = LabelImageBoxKernel::getPadded(count);
+    this->mCount = count;
+    this->mWidth.resize(padded);
+    this->mHeight.resize(padded);
+    this->mIous.resize(padded);
+    this->mAssigned.assign(count, -1);
+
+    this->seed(threads, k, model, random, anchorWidth, anchorHeight);
+
+    auto &&prog = Program(iterations);
+    for (i = 0; i < iterations; ++i) {
+      this->assign(threads, anchorWidth, anchorHeight, clusters);
+      prog.updateOne();
+      if (clusters[0].mChanged == 0) {
+        prog.update(iterations - i - 1);
+        break;
+      }
+
+      for (Jsize j = 0; j < anchorWidth.size(); ++j) {
+        auto &&n = clusters[0].mCount[j];
+        if (n == 0)
+          continue;
+        anchorWidth[j] = static_cast<Jfloat>(clusters[0].mWidth[j] / static_cast<Jdouble>(n));
+        anchorHeight[j] = static_cast<Jfloat>(clusters[0].mHeight[j] / static_cast<Jdouble>(n));
+      }
+    }
+    this->assign(threads, anchorWidth, anchorHeight, clusters);
+
+    auto &&order = std::vector<Jint>(k);
+    for (Jint j = 0; j < k; ++j)
+      order[j] = j;
+    std::sort(order.begin(), order.end(), [&](Jint a, Jint b) {
+      return (anchorWidth[a] * anchorHeight[a]) < (anchorWidth[b] * anchorHeight[b]);
+    });
+    for (Jint j = 0; j < k; ++j)
+      Log::info(FORMAT_ANCHOR, j, anchorWidth[order[j]], anchorHeight[order[j]],
+                clusters[0].mCount[order[j]]);
+
+    Log::info(FORMAT_DONE, k, static_cast<Jlong>(count), std::min(i + 1, iterations),
+              clusters[0].mIou / static_cast<Jdouble>(count));
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_BOX_HPP
@@ -0,0 +1,604 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_COLUMN_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_COLUMN_HPP
+
+namespace tfutils {
+
+// Section order of a column file; rows are grouped by image so IMAGE_OFFSET
+// holds images + 1 row indices and the rows of image i are [offset[i], offset[i + 1]).
+enum ColumnSection : Jint {
+  COLUMN_MODEL = 0,
+  COLUMN_LABEL,
+  COLUMN_X1,
+  COLUMN_Y1,
+  COLUMN_X2,
+  COLUMN_Y2,
+  COLUMN_X3,
+  COLUMN_Y3,
+  COLUMN_X4,
+  COLUMN_Y4,
+  IMAGE_OFFSET,
+  IMAGE_WIDTH,
+  IMAGE_HEIGHT,
+  STRING_MODEL,
+  STRING_LABEL,
+  STRING_PATH,
+  SECTION_COUNT,
+};
+
+class ColumnHeader {
+public:
+  constexpr static Jchar MAGIC[] = "TFC1";
+  constexpr static Juint VERSION = 1;
+  constexpr static Jsize ALIGN = 8;
+
+  Jchar mMagic[4];
+  Juint mVersion;
+  Julong mRows;
+  Julong mImages;
+  Julong mSections[SECTION_COUNT + 1];
+};
+
+template <class T> class ColumnSpan {
+private:
+  const T *mData;
+  Jsize mSize;
+
+public:
+  ColumnSpan() : mData(), mSize() {}
+
+  ColumnSpan(const T *data, Jsize size) : mData(data), mSize(size) {}
+
+  [[nodiscard]] const T *begin() const { return this->mData; }
+
+  [[nodiscard]] const T *end() const { return this->mData + this->mSize; }
+
+  [[nodiscard]] Jsize size() const { return this->mSize; }
+
+  [[nodiscard]] ColumnSpan sub(Jsize begin, Jsize end) const {
+    return ColumnSpan(this->mData + begin, end - begin);
+  }
+
+  const T &operator[](Jsize v) const { return this->mData[v]; }
+};
+
+// A string table is a Julong count, count + 1 Julong offsets and the characters.
+class ColumnStrings {
+private:
+  ColumnSpan<Julong> mOffsets;
+  const Jchar *mData;
+
+public:
+  ColumnStrings() : mOffsets(), mData() {}
+
+  ColumnStrings(ColumnSpan<Julong> offsets, const Jchar *data) : mOffsets(offsets), mData(data) {}
+
+  [[nodiscard]] Jsize size() const {
+    return (this->mOffsets.size() > 0) ? this->mOffsets.size() - 1 : 0;
+  }
+
+  std::string_view operator[](Jsize v) const {
+    if (v >= this->size())
+      return std::string_view();
+    return std::string_view(&this->mData[this->mOffsets[v]],
+                            this->mOffsets[v + 1] - this->mOffsets[v]);
+  }
+};
+
+class ColumnFile {
+private:
+  MappedFile mFile;
+  ColumnHeader mHeader;
+  ColumnStrings mModels;
+  ColumnStrings mLabels;
+  ColumnStrings mPaths;
+  Jbool mValid;
+
+  [[nodiscard]] const Jbyte *section(Jint v) const {
+    return this->mFile.getData() + this->mHeader.mSections[v];
+  }
+
+  [[nodiscard]] Jsize length(Jint v) const {
+    return this->mHeader.mSections[v + 1] - this->mHeader.mSections[v];
+  }
+
+  template <class T> [[nodiscard]] ColumnSpan<T> span(Jint v, Jsize count) const {
+    return ColumnSpan<T>(reinterpret_cast<const T *>(this->section(v)), count);
+  }
+
+  Jbool strings(Jint v, ColumnStrings &out) const {
+    Julong count = 0;
+
+    if (this->length(v) < sizeof(count))
+      return false;
+    memcpy(&count, this->section(v), sizeof(count));
+    if ((this->length(v) - sizeof(count)) / sizeof(Julong) <= count)
+      return false;
+
+    auto &&offsets = ColumnSpan<Julong>(
+        reinterpret_cast<const Julong *>(this->section(v) + sizeof(count)), count + 1);
+    auto &&heap = sizeof(count) + (count + 1) * sizeof(Julong);
+    for (Jsize i = 0; i < count; ++i) {
+      if (offsets[i] > offsets[i + 1])
+        return false;
+    }
+    if ((offsets[0] != 0) || (offsets[count] > this->length(v) - heap))
+      return false;
+
+    out = ColumnStrings(offsets, reinterpret_cast<const Jchar *>(this->section(v) + heap));
+    return true;
+  }
+
+  Jbool validate() {
+    Jint i = 0;
+
+    if (this->mFile.getSize() < sizeof(this->mHeader))
+      return false;
+    memcpy(&this->mHeader, this->mFile.getData(), sizeof(this->mHeader));
+    if ((memcmp(this->mHeader.mMagic, ColumnHeader::MAGIC, sizeof(this->mHeader.mMagic)) != 0) ||
+        (this->mHeader.mVersion != ColumnHeader::VERSION))
+      return false;
+
+    auto &&rows = this->mHeader.mRows;
+    auto &&images = this->mHeader.mImages;
+    if (this->mHeader.mSections[SECTION_COUNT] != this->mFile.getSize())
+      return false;
+    for (i = 0; i < SECTION_COUNT; ++i) {
+      if ((this->mHeader.mSections[i] % ColumnHeader::ALIGN != 0) ||
+          (this->mHeader.mSections[i] < sizeof(this->mHeader)) ||
+          (this->mHeader.mSections[i] > this->mHeader.mSections[i + 1]))
+        return false;
+    }
+
+    for (i = COLUMN_MODEL; i <= COLUMN_Y4; ++i) {
+      if (this->length(i) / sizeof(Juint) < rows)
+        return false;
+    }
+    if ((this->length(IMAGE_OFFSET) / sizeof(Julong) <= images) ||
+        (this->length(IMAGE_WIDTH) / sizeof(Jint) < images) ||
+        (this->length(IMAGE_HEIGHT) / sizeof(Jint) < images))
+      return false;
+
+    auto &&offsets = this->getOffsets();
+    for (Jsize j = 0; j < images; ++j) {
+      if (offsets[j] > offsets[j + 1])
+        return false;
+    }
+    if ((offsets[0] != 0) || (offsets[images] != rows))
+      return false;
+
+    if (!this->strings(STRING_MODEL, this->mModels) ||
+        !this->strings(STRING_LABEL, this->mLabels) || !this->strings(STRING_PATH, this->mPaths))
+      return false;
+    return (this->mPaths.size() == images);
+  }
+
+public:
+  constexpr static Jchar SURRFIX[] = ".tfc";
+
+  explicit ColumnFile(const std::string &v)
+      : mFile(v), mHeader(), mModels(), mLabels(), mPaths(), mValid() {
+    this->mValid = this->validate();
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return this->mValid; }
+
+  [[nodiscard]] Jsize getRows() const { return this->mHeader.mRows; }
+
+  [[nodiscard]] Jsize getImages() const { return this->mHeader.mImages; }
+
+  [[nodiscard]] ColumnSpan<Juint> getModel() const {
+    return this->span<Juint>(COLUMN_MODEL, this->getRows());
+  }
+
+  [[nodiscard]] ColumnSpan<Juint> getLabel() const {
+    return this->span<Juint>(COLUMN_LABEL, this->getRows());
+  }
+
+  // v is 0 to 7 for x1, y1, x2, y2, x3, y3, x4, y4.
+  [[nodiscard]] ColumnSpan<Jfloat> getPoint(Jint v) const {
+    return this->span<Jfloat>(COLUMN_X1 + v, this->getRows());
+  }
+
+  [[nodiscard]] ColumnSpan<Julong> getOffsets() const {
+    return this->span<Julong>(IMAGE_OFFSET, this->getImages() + 1);
+  }
+
+  [[nodiscard]] ColumnSpan<Jint> getWidth() const {
+    return this->span<Jint>(IMAGE_WIDTH, this->getImages());
+  }
+
+  [[nodiscard]] ColumnSpan<Jint> getHeight() const {
+    return this->span<Jint>(IMAGE_HEIGHT, this->getImages());
+  }
+
+  [[nodiscard]] const ColumnStrings &getModelNames() const { return this->mModels; }
+
+  [[nodiscard]] const ColumnStrings &getLabelNames() const { return this->mLabels; }
+
+  [[nodiscard]] const ColumnStrings &getPaths() const { return this->mPaths; }
+
+  void getPoints(Jsize row, Jfloat (&v)[8]) const {
+    for (Jint i = 0; i < 8; ++i)
+      v[i] = this->getPoint(i)[row];
+  }
+
+  void getRow(Jsize image, Jsize row, TFCSVRow &v) const {
+    Jfloat points[8] = {};
+
+    this->getPoints(row, points);
+    v.setModel(std::string(this->mModels[this->getModel()[row]]));
+    v.setPath(std::string(this->mPaths[image]));
+    v.setTarget(std::string(this->mLabels[this->getLabel()[row]]));
+    v.setX1(points[0]);
+    v.setY1(points[1]);
+    v.setX2(points[2]);
+    v.setY2(points[3]);
+    v.setX3(points[4]);
+    v.setY3(points[5]);
+    v.setX4(points[6]);
+    v.setY4(points[7]);
+  }
+
+  void advise(Jint v) { this->mFile.advise(v); }
+};
+
+class ColumnWriter {
+private:
+  constexpr static Jsize SIZE_CHUNK = 64 * 1024;
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+
+  std::vector<std::string> mModelNames;
+  std::vector<std::string> mLabelNames;
+  std::map<std::string, Juint> mModelIds;
+  std::map<std::string, Juint> mLabelIds;
+
+  std::vector<std::string> mPaths;
+  std::vector<Jint> mWidths;
+  std::vector<Jint> mHeights;
+
+  std::vector<Juint> mImages;
+  std::vector<Juint> mModels;
+  std::vector<Juint> mLabels;
+  std::vector<Jfloat> mPoints[8];
+
+  static Juint getId(const std::string &v, std::map<std::string, Juint> &ids,
+                     std::vector<std::string> &names) {
+    auto &&it = ids.find(v);
+    if (it != ids.end())
+      return it->second;
+
+    auto &&id = static_cast<Juint>(names.size());
+    ids.emplace(v, id);
+    names.push_back(v);
+    return id;
+  }
+
+  static Jbool pad(FILE *file, Julong &position) {
+    Jchar zero[ColumnHeader::ALIGN] = {};
+
+    auto &&len = (ColumnHeader::ALIGN - position % ColumnHeader::ALIGN) % ColumnHeader::ALIGN;
+    position += len;
+    return (len == 0) || (fwrite(zero, len, 1, file) == 1);
+  }
+
+  template <class T>
+  static Jbool write(FILE *file, Julong &position, const T *data, Jsize count) {
+    position += count * sizeof(T);
+    return (count == 0) || (fwrite(data, sizeof(T) * count, 1, file) == 1);
+  }
+
+  template <class T>
+  static Jbool write(FILE *file, Julong &position, const std::vector<T> &column,
+                     const std::vector<Juint> &order) {
+    std::vector<T> buffer;
+
+    buffer.reserve(std::min(order.size(), SIZE_CHUNK));
+    for (Jsize begin = 0; begin < order.size(); begin += SIZE_CHUNK) {
+      auto end = std::min(order.size(), begin + SIZE_CHUNK);
+      buffer.clear();
+      for (auto i = begin; i < end; ++i)
+        buffer.push_back(column[order[i]]);
+      if (!write(file, position, buffer.data(), buffer.size()))
+        return false;
+    }
+    return true;
+  }
+
+  static Jbool write(FILE *file, Julong &position, const std::vector<std::string> &v) {
+    std::vector<Julong> offsets;
+
+    offsets.reserve(v.size() + 1);
+    offsets.push_back(0);
+    for (auto &&one : v)
+      offsets.push_back(offsets.back() + one.size());
+
+    Julong count = v.size();
+    if (!write(file, position, &count, 1) || !write(file, position, offsets.data(), offsets.size()))
+      return false;
+    for (auto &&one : v) {
+      if (!write(file, position, one.data(), one.size()))
+        return false;
+    }
+    return true;
+  }
+
+  Jbool write(FILE *file) {
+    Jint i = 0;
+    Julong position = 0;
+    ColumnHeader header = {};
+    std::vector<Julong> offsets(this->mPaths.size() + 1);
+    std::vector<Juint> order(this->mImages.size());
+
+    // Counting sort by image keeps rows of one image contiguous and in input order.
+    for (auto &&image : this->mImages)
+      ++offsets[image + 1];
+    for (Jsize j = 1; j < offsets.size(); ++j)
+      offsets[j] += offsets[j - 1];
+    auto &&next = std::vector<Julong>(offsets.begin(), offsets.end() - 1);
+    for (Jsize j = 0; j < this->mImages.size(); ++j)
+      order[next[this->mImages[j]]++] = static_cast<Juint>(j);
+
+    memcpy(header.mMagic, ColumnHeader::MAGIC, sizeof(header.mMagic));
+    header.mVersion = ColumnHeader::VERSION;
+    header.mRows = this->mImages.size();
+    header.mImages = this->mPaths.size();
+    if (!write(file, position, &header, 1))
+      return false;
+
+    auto &&ret = true;
+    auto &&begin = [&](Jint v) {
+      ret = ret && pad(file, position);
+      header.mSections[v] = position;
+    };
+
+    begin(COLUMN_MODEL);
+    ret = ret && write(file, position, this->mModels, order);
+    begin(COLUMN_LABEL);
+    ret = ret && write(file, position, this->mLabels, order);
+    for (i = 0; i < 8; ++i) {
+      begin(COLUMN_X1 + i);
+      ret = ret && write(file, position, this->mPoints[i], order);
+    }
+    begin(IMAGE_OFFSET);
+    ret = ret && write(file, position, offsets.data(), offsets.size());
+    begin(IMAGE_WIDTH);
+    ret = ret && write(file, position, this->mWidths.data(), this->mWidths.size());
+    begin(IMAGE_HEIGHT);
+    ret = ret && write(file, position, this->mHeights.data(), this->mHeights.size());
+    begin(STRING_MODEL);
+    ret = ret && write(file, position, this->mModelNames);
+    begin(STRING_LABEL);
+    ret = ret && write(file, position, this->mLabelNames);
+    begin(STRING_PATH);
+    ret = ret && write(file, position, this->mPaths);
+    begin(SECTION_COUNT);
+
+    if (!ret || (fseek(file, 0, SEEK_SET) != 0))
+      return false;
+    return (fwrite(&header, sizeof(header), 1, file) == 1);
+  }
+
+public:
+  ColumnWriter()
+      : mModelNames(), mLabelNames(), mModelIds(), mLabelIds(), mPaths(), mWidths(), mHeights(),
+        mImages(), mModels(), mLabels(), mPoints() {}
+
+  void reserve(Jsize rows, Jsize images) {
+    this->mPaths.reserve(images);
+    this->mWidths.reserve(images);
+    this->mHeights.reserve(images);
+    this->mImages.reserve(rows);
+    this->mModels.reserve(rows);
+    this->mLabels.reserve(rows);
+    for (auto &&column : this->mPoints)
+      column.reserve(rows);
+  }
+
+  Juint getModel(const std::string &v) { return getId(v, this->mModelIds, this->mModelNames); }
+
+  Juint getLabel(const std::string &v) { return getId(v, this->mLabelIds, this->mLabelNames); }
+
+  [[nodiscard]] Jsize getRows() const { return this->mImages.size(); }
+
+  [[nodiscard]] Jsize getImages() const { return this->mPaths.size(); }
+
+  [[nodiscard]] Jsize getLabels() const { return this->mLabelNames.size(); }
+
+  Juint addImage(std::string path, Jint width, Jint height) {
+    this->mPaths.emplace_back(move(path));
+    this->mWidths.push_back(width);
+    this->mHeights.push_back(height);
+    return static_cast<Juint>(this->mPaths.size() - 1);
+  }
+
+  void add(Juint image, Juint model, Juint label, const Jfloat (&v)[8]) {
+    this->mImages.push_back(image);
+    this->mModels.push_back(model);
+    this->mLabels.push_back(label);
+    for (Jint i = 0; i < 8; ++i)
+      this->mPoints[i].push_back(v[i]);
+  }
+
+  // Writes through a temporary file so out may be the file currently being read.
+  Jbool exported(const std::string &out) {
+    auto &&temp = out + SURRFIX_TEMP;
+    auto &&file = fopen(temp.c_str(), MODEL_WRITER_ONLY);
+    if (file == nullptr)
+      return false;
+
+    auto &&ret = this->write(file);
+    ret = (fclose(file) == 0) && ret;
+    if (ret && (rename(temp.c_str(), out.c_str()) == 0))
+      return true;
+
+    remove(temp.c_str());
+    return false;
+  }
+};
+
+class TensorflowColumns : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_BLOCK = 1024;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, open failed";
+  constexpr static Jchar FORMAT_INVALID[] = "file: %s, not a column file";
+  constexpr static Jchar FORMAT_DONE[] = "images: %lld, rows: %lld, labels: %lld";
+
+  class Image {
+  public:
+    std::string mPath;
+    Jint mWidth;
+    Jint mHeight;
+    std::vector<std::string> mLabels;
+    std::vector<Jfloat> mPoints;
+
+    Image() : mPath(), mWidth(), mHeight(), mLabels(), mPoints() {}
+  };
+
+  static void fromXml(const std::string &path, Image &image) {
+    Jfloat v[8] = {};
+
+    auto &&xml = LabelImageXML(path);
+    auto &&width = xml.getSize().getWidth();
+    auto &&height = xml.getSize().getHeight();
+
+    image.mPath = std::string(TFCSVRow::SYMBOL_PATH) + "/" + xml.getFilename();
+    image.mWidth = width;
+    image.mHeight = height;
+    image.mLabels.clear();
+    image.mPoints.clear();
+    for (auto &&object : xml.getObjects()) {
+      auto &&box = object.getBndbox();
+      GoogleCloudCSVFormat::getPoints(width, height, box.getMinX(), box.getMinY(), box.getMaxX(),
+                                      box.getMaxY(), v);
+      image.mLabels.push_back(object.getName());
+      image.mPoints.insert(image.mPoints.end(), std::begin(v), std::end(v));
+    }
+  }
+
+  static void fromXml(const std::filesystem::path &in, Jint threads, ColumnWriter &out) {
+    Jfloat v[8] = {};
+    std::vector<std::string> paths;
+    std::vector<Image> images;
+    UP<File> file(new File());
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in))
+        paths.push_back(one->getAbstractPath());
+      std::sort(paths.begin(), paths.end());
+    }
+
+    auto &&mark = out.getModel(TFCSVRow::SYMBOL_MARK);
+    auto &&prog = Program(paths.size());
+    for (Jsize begin = 0; begin < paths.size(); begin += SIZE_BLOCK) {
+      auto end = std::min(paths.size(), begin + SIZE_BLOCK);
+      images.resize(end - begin);
+      Parallel::forEach(threads, end - begin,
+                        [&](Jsize i, Jint) { fromXml(paths[begin + i], images[i]); });
+
+      for (auto &&image : images) {
+        auto &&id = out.addImage(move(image.mPath), image.mWidth, image.mHeight);
+        for (Jsize i = 0; i < image.mLabels.size(); ++i) {
+          std::copy_n(&image.mPoints[i * 8], 8, v);
+          out.add(id, mark, out.getLabel(image.mLabels[i]), v);
+        }
+      }
+      prog.update(static_cast<Jint>(end - begin));
+    }
+  }
+
+  static Jbool fromCsv(const std::string &in, ColumnWriter &out) {
+    Juint image = 0;
+    TFCSVRow row;
+    std::string buffer;
+    std::string last;
+    std::map<std::string, Juint> images;
+
+    return TFCSV::forEachLine(in, 1, [&](std::string_view line, Jint) {
+      if (!TFCSV::parseLine(line, row, buffer))
+        return;
+
+      if (out.getImages() == 0 || (row.getPath() != last)) {
+        auto &&it = images.find(row.getPath());
+        image = (it != images.end()) ? it->second : out.addImage(row.getPath(), 0, 0);
+        if (it == images.end())
+          images.emplace(row.getPath(), image);
+        last = row.getPath();
+      }
+
+      Jfloat v[8] = {row.getX1(), row.getY1(), row.getX2(), row.getY2(),
+                     row.getX3(), row.getY3(), row.getX4(), row.getY4()};
+      out.add(image, out.getModel(row.getModel()), out.getLabel(row.getTarget()), v);
+    });
+  }
+
+  static Jint toCsv(const ColumnFile &in, const std::string &out) {
+    TFCSVRow row;
+
+    auto &&file = fopen(out.c_str(), MODEL_WRITER_ONLY);
+    if (file == nullptr)
+      return -1;
+
+    auto &&offsets = in.getOffsets();
+    for (Jsize i = 0; i < in.getImages(); ++i) {
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+        in.getRow(i, j, row);
+        TFCSV::write(file, row);
+      }
+    }
+    fclose(file);
+    return 0;
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    ColumnWriter out;
+
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&output = std::string((*v)[1]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    if (in.extension() == ColumnFile::SURRFIX) {
+      auto &&file = ColumnFile(in);
+      if (!file.isOpen()) {
+        Log::error(FORMAT_INVALID, in.c_str());
+        return 0;
+      }
+      return toCsv(file, output);
+    }
+
+    if (Gzip::getExtension(in) == SURRFIX_CSV) {
+      if (!fromCsv(in, out)) {
+        Log::error(FORMAT_FAILED, in.c_str());
+        return 0;
+      }
+    } else {
+      fromXml(in, threads, out);
+    }
+
+    if (!out.exported(output)) {
+      Log::error(FORMAT_FAILED, output.c_str());
+      return 0;
+    }
+    Log::info(FORMAT_DONE, static_cast<Jlong>(out.getImages()), static_cast<Jlong>(out.getRows()),
+              static_cast<Jlong>(out.getLabels()));
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_COLUMN_HPP
@@ -0,0 +1,251 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_DATASET_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_DATASET_HPP
+
+namespace tfutils {
+
+class DatasetFile {
+public:
+  std::string mPath;
+  std::string mName;
+  Jsize mSize;
+  uint64_t mHash;
+
+  DatasetFile(std::string path, std::string name, Jsize size)
+      : mPath(move(path)), mName(move(name)), mSize(size), mHash() {}
+};
+
+class TensorflowDedup : public AbstractCommand {
+private:
+  constexpr static Jint SIZE_READ = 4 * 1024 * 1024;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_LINK[] = ".dedup";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar MODEL_REPORT[] = "report";
+  constexpr static Jchar MODEL_LINK[] = "link";
+  constexpr static Jchar MODEL_DELETE[] = "delete";
+
+  constexpr static Jchar FORMAT_DUPLICATE[] = "file: %s-%s-%s";
+  constexpr static Jchar FORMAT_CHANGED[] = "file: %s, content differs from %s, skipped";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, %s failed";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, groups: %d, duplicates: %d, reclaimed: %lld";
+
+  static std::string stem(const std::string &v) {
+    return std::filesystem::path(v).replace_extension().string();
+  }
+
+  static Jbool isAnnotation(const DatasetFile &v) {
+    return (std::filesystem::path(v.mPath).extension() == SURRFIX);
+  }
+
+  static Jbool hash(DatasetFile &file, std::vector<Jbyte> &buffer) {
+    ssize_t retLen = 0;
+    Hash64 hash;
+
+    auto &&fd = open(file.mPath.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    do {
+      retLen = read(fd, buffer.data(), buffer.size());
+      if (retLen > 0)
+        hash.update(buffer.data(), retLen);
+    } while (retLen > 0);
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    file.mHash = hash.digest();
+    return (retLen == 0);
+  }
+
+  static Jbool isSame(const std::string &a, const std::string &b, std::vector<Jbyte> &bufferA,
+                      std::vector<Jbyte> &bufferB) {
+    Jbool ret = true;
+    ssize_t lenA = 0;
+    ssize_t lenB = 0;
+
+    auto &&fdA = open(a.c_str(), O_RDONLY);
+    auto &&fdB = open(b.c_str(), O_RDONLY);
+
+    do {
+      if ((fdA < 0) || (fdB < 0)) {
+        ret = false;
+        break;
+      }
+
+      do {
+        lenA = read(fdA, bufferA.data(), bufferA.size());
+        lenB = read(fdB, bufferB.data(), bufferB.size());
+        if ((lenA != lenB) || (lenA < 0) || (memcmp(bufferA.data(), bufferB.data(), lenA) != 0))
+          ret = false;
+      } while (ret && (lenA > 0));
+    } while (false);
+
+    if (fdA >= 0)
+      close(fdA);
+    if (fdB >= 0)
+      close(fdB);
+    return ret;
+  }
+
+  static Jbool link(const std::string &keep, const std::string &duplicate) {
+    auto &&temp = duplicate + SURRFIX_LINK;
+    if (::link(keep.c_str(), temp.c_str()) != 0)
+      return false;
+    if (rename(temp.c_str(), duplicate.c_str()) != 0) {
+      unlink(temp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  static Jlong remove(const DatasetFile &duplicate, std::map<std::string, Jsize> &removed) {
+    Jlong ret = 0;
+
+    if (removed.count(duplicate.mPath) != 0)
+      return ret;
+    if (File::remove(duplicate.mPath) != 0) {
+      Log::error(FORMAT_FAILED, duplicate.mPath.c_str(), MODEL_DELETE);
+      return ret;
+    }
+    removed.emplace(duplicate.mPath, duplicate.mSize);
+    ret += static_cast<Jlong>(duplicate.mSize);
+
+    auto &&xml = std::filesystem::path(duplicate.mPath).replace_extension(SURRFIX).string();
+    if ((xml == duplicate.mPath) || (removed.count(xml) != 0) || (!File::isExist(xml)))
+      return ret;
+
+    auto &&size = std::filesystem::file_size(xml);
+    if (File::remove(xml) == 0) {
+      removed.emplace(xml, size);
+      ret += static_cast<Jlong>(size);
+    }
+    return ret;
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jint groups = 0;
+    Jint duplicates = 0;
+    Jlong reclaimed = 0;
+    std::string model = MODEL_REPORT;
+    std::vector<DatasetFile> files;
+    std::vector<DatasetFile *> candidates;
+    std::map<std::string, Jsize> removed;
+    std::set<std::string> images;
+    std::map<std::pair<Jsize, uint64_t>, std::vector<DatasetFile *>> hashes;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 1)
+      return -1;
+    if (v->getLength() > 1)
+      model = (*v)[1];
+    if ((model != MODEL_REPORT) && (model != MODEL_LINK) && (model != MODEL_DELETE))
+      return -1;
+
+    auto &&in = (*v)[0];
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    if (File::isFile(in))
+      return -1;
+
+    for (auto &&one : file->getFilesInDirectory(in)) {
+      auto &&status = std::filesystem::status(one->getAbstractPath());
+      if (!std::filesystem::is_regular_file(status))
+        continue;
+      files.emplace_back(one->getAbstractPath(), one->getName(),
+                         std::filesystem::file_size(one->getAbstractPath()));
+    }
+
+    std::sort(files.begin(), files.end(), [](const DatasetFile &a, const DatasetFile &b) {
+      return (a.mSize != b.mSize) ? (a.mSize < b.mSize) : (a.mPath < b.mPath);
+    });
+    for (Jsize i = 0; i < files.size(); ++i) {
+      auto &&previous = (i > 0) && (files[i - 1].mSize == files[i].mSize);
+      auto &&next = ((i + 1) < files.size()) && (files[i + 1].mSize == files[i].mSize);
+      if ((files[i].mSize > 0) && (previous || next))
+        candidates.push_back(&files[i]);
+    }
+
+    auto &&buffers = std::vector<std::vector<Jbyte>>(threads * 2);
+    auto &&failed = std::vector<Jbyte>(candidates.size());
+    auto &&prog = Program(candidates.size());
+    Parallel::forEach(threads, candidates.size(), [&](Jsize i, Jint worker) {
+      auto &&buffer = buffers[worker];
+      if (buffer.empty())
+        buffer.resize(SIZE_READ);
+      failed[i] = !hash(*candidates[i], buffer);
+      prog.updateOne();
+    });
+
+    for (Jsize i = 0; i < candidates.size(); ++i) {
+      if (!failed[i])
+        hashes[{candidates[i]->mSize, candidates[i]->mHash}].push_back(candidates[i]);
+    }
+
+    for (auto &&one : files) {
+      if (!isAnnotation(one))
+        images.emplace(stem(one.mPath));
+    }
+
+    buffers[0].resize(SIZE_READ);
+    buffers[1].resize(SIZE_READ);
+    for (auto &&annotation : {false, true}) {
+      for (auto &&kv : hashes) {
+        auto &&group = kv.second;
+        if (isAnnotation(*group.front()) != annotation)
+          continue;
+
+        auto &&keep = std::find_if(group.begin(), group.end(), [&removed](DatasetFile *one) {
+          return (removed.count(one->mPath) == 0);
+        });
+        if ((group.size() < 2) || (keep == group.end()))
+          continue;
+
+        ++groups;
+        for (auto it = keep + 1; it != group.end(); ++it) {
+          auto &&duplicate = *it;
+          if (removed.count(duplicate->mPath) != 0)
+            continue;
+          if (std::filesystem::equivalent((*keep)->mPath, duplicate->mPath))
+            continue;
+          if (annotation && (model == MODEL_DELETE) && (images.count(stem(duplicate->mPath)) != 0))
+            continue;
+
+          ++duplicates;
+          Log::info(FORMAT_DUPLICATE, (*keep)->mName.c_str(), model.c_str(),
+                    duplicate->mName.c_str());
+          if (model == MODEL_REPORT) {
+            reclaimed += static_cast<Jlong>(duplicate->mSize);
+            continue;
+          }
+
+          if (!isSame((*keep)->mPath, duplicate->mPath, buffers[0], buffers[1])) {
+            Log::error(FORMAT_CHANGED, duplicate->mPath.c_str(), (*keep)->mPath.c_str());
+            continue;
+          }
+
+          if (model == MODEL_DELETE) {
+            reclaimed += remove(*duplicate, removed);
+            images.erase(stem(duplicate->mPath));
+          } else if (link((*keep)->mPath, duplicate->mPath)) {
+            reclaimed += static_cast<Jlong>(duplicate->mSize);
+          } else {
+            Log::error(FORMAT_FAILED, duplicate->mPath.c_str(), MODEL_LINK);
+          }
+        }
+      }
+    }
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(files.size()), groups, duplicates, reclaimed);
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_DATASET_HPP
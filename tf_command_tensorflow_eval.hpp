@@ -0,0 +1,340 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_EVAL_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_EVAL_HPP
+
+namespace tfutils {
+
+class EvaluationRow {
+public:
+  std::string_view mPath;
+  std::string_view mLabel;
+  Jint mImage;
+  Jint mClass;
+  Jfloat mScore;
+  Jfloat mMinX;
+  Jfloat mMinY;
+  Jfloat mMaxX;
+  Jfloat mMaxY;
+
+  EvaluationRow()
+      : mPath(), mLabel(), mImage(-1), mClass(-1), mScore(), mMinX(), mMinY(), mMaxX(), mMaxY() {}
+};
+
+class EvaluationResult {
+public:
+  Jfloat mAP;
+  Jfloat mRecall;
+  std::vector<Jfloat> mRecalls;
+  std::vector<Jfloat> mPrecisions;
+
+  EvaluationResult() : mAP(), mRecall(), mRecalls(), mPrecisions() {}
+};
+
+class TensorflowEval : public AbstractCommand {
+private:
+  constexpr static Jint FIELD_SCORE = 11;
+
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar OPTION_CURVES[] = "curves";
+  constexpr static Jchar THRESHOLDS[] = "0.5,0.55,0.6,0.65,0.7,0.75,0.8,0.85,0.9,0.95";
+
+  constexpr static Jchar FORMAT_TABLE_HEAD[] = "%-24s %10s %10s %8s";
+  constexpr static Jchar FORMAT_TABLE_ROW[] = "%-24s %10lld %10lld %8.4f";
+  constexpr static Jchar FORMAT_TABLE_IOU[] = " %8s";
+  constexpr static Jchar FORMAT_TABLE_AP[] = " %8.4f";
+  constexpr static Jchar FORMAT_TABLE_NAME[] = "AP@%.2f";
+  constexpr static Jchar FORMAT_CURVE[] = "%s,%.2f,%.6f,%.6f\n";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, read failed";
+  constexpr static Jchar FORMAT_DONE[] = "images: %d, truth: %d, predictions: %d, mAP: %.4f";
+
+  class Truth {
+  public:
+    std::vector<Jint> mImages;
+    std::vector<Jfloat> mMinX;
+    std::vector<Jfloat> mMinY;
+    std::vector<Jfloat> mMaxX;
+    std::vector<Jfloat> mMaxY;
+    std::vector<Jsize> mClasses;
+
+    Truth() : mImages(), mMinX(), mMinY(), mMaxX(), mMaxY(), mClasses() {}
+  };
+
+  static Jbool load(InputFile &file, Jint threads, Jbool scored,
+                    std::vector<EvaluationRow> &rows) {
+    std::vector<std::string_view> lines;
+
+    if (!file.isOpen())
+      return false;
+
+    file.forEachLine([&lines](std::string_view line) { lines.push_back(line); });
+
+    auto &&buffers = std::vector<std::string>(threads);
+    auto &&parsed = std::vector<EvaluationRow>(lines.size());
+    auto &&valid = std::vector<Jbyte>(lines.size());
+    Parallel::forEach(threads, lines.size(), [&](Jsize i, Jint worker) {
+      TFCSVRow row;
+      auto &&one = parsed[i];
+      if (!TFCSV::parseLine(lines[i], row, buffers[worker]))
+        return;
+
+      auto &&score = TFCSV::field(lines[i], FIELD_SCORE);
+      if (scored && score.empty())
+        return;
+
+      valid[i] = 1;
+      one.mPath = TFCSV::field(lines[i], 1);
+      one.mLabel = TFCSV::field(lines[i], 2);
+      one.mScore = scored ? std::strtof(std::string(score).c_str(), nullptr) : 1;
+      one.mMinX = std::min(row.getX1(), row.getX3());
+      one.mMinY = std::min(row.getY1(), row.getY3());
+      one.mMaxX = std::max(row.getX1(), row.getX3());
+      one.mMaxY = std::max(row.getY1(), row.getY3());
+    });
+
+    for (Jsize i = 0; i < parsed.size(); ++i) {
+      if (valid[i] != 0)
+        rows.push_back(parsed[i]);
+    }
+    return true;
+  }
+
+  static Jint find(const std::vector<std::string_view> &v, std::string_view key) {
+    auto &&it = std::lower_bound(v.begin(), v.end(), key);
+    if ((it == v.end()) || (*it != key))
+      return -1;
+    return static_cast<Jint>(it - v.begin());
+  }
+
+  static std::vector<std::string_view> unique(const std::vector<EvaluationRow> &rows,
+                                              std::string_view EvaluationRow::*member) {
+    std::vector<std::string_view> ret;
+
+    ret.reserve(rows.size());
+    for (auto &&one : rows)
+      ret.push_back(one.*member);
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+  }
+
+  static Jfloat average(const std::vector<Jfloat> &recalls, std::vector<Jfloat> precisions) {
+    Jfloat ret = 0;
+    Jfloat previous = 0;
+
+    for (auto i = static_cast<Jlong>(precisions.size()) - 2; i >= 0; --i)
+      precisions[i] = std::max(precisions[i], precisions[i + 1]);
+    for (Jsize i = 0; i < recalls.size(); ++i) {
+      ret += (recalls[i] - previous) * precisions[i];
+      previous = recalls[i];
+    }
+    return ret;
+  }
+
+  static void evaluate(const Truth &truth, const std::vector<EvaluationRow> &predictions,
+                       std::pair<Jsize, Jsize> range, Jsize cls, Jfloat threshold,
+                       std::vector<Jbool> &matched, std::vector<Jfloat> &ious,
+                       EvaluationResult &result) {
+    Jlong tp = 0;
+    Jlong fp = 0;
+
+    auto &&begin = truth.mClasses[cls];
+    auto &&end = truth.mClasses[cls + 1];
+    auto &&count = end - begin;
+    auto &&images = truth.mImages.begin();
+
+    for (auto i = range.first; i < range.second; ++i) {
+      auto &&one = predictions[i];
+      auto &&lower = std::lower_bound(images + begin, images + end, one.mImage);
+      auto &&upper = std::upper_bound(lower, images + end, one.mImage);
+      auto &&first = static_cast<Jsize>(lower - images);
+      auto &&n = static_cast<Jsize>(upper - lower);
+      Jlong best = -1;
+      Jfloat bestIou = threshold;
+
+      if (n != 0) {
+        if (ious.size() < LabelImageBoxKernel::getPadded(n))
+          ious.resize(LabelImageBoxKernel::getPadded(n));
+        LabelImageBoxKernel::iou(&truth.mMinX[first], &truth.mMinY[first], &truth.mMaxX[first],
+                                 &truth.mMaxY[first], n, one.mMinX, one.mMinY, one.mMaxX,
+                                 one.mMaxY, ious.data());
+        for (Jsize j = 0; j < n; ++j) {
+          if ((!matched[first + j]) && (ious[j] >= bestIou)) {
+            best = static_cast<Jlong>(first + j);
+            bestIou = ious[j];
+          }
+        }
+      }
+
+      if (best >= 0) {
+        matched[best] = true;
+        ++tp;
+      } else {
+        ++fp;
+      }
+      result.mRecalls.push_back(static_cast<Jfloat>(tp) / static_cast<Jfloat>(count));
+      result.mPrecisions.push_back(static_cast<Jfloat>(tp) / static_cast<Jfloat>(tp + fp));
+    }
+
+    std::fill(matched.begin() + begin, matched.begin() + end, false);
+    result.mRecall = result.mRecalls.empty() ? 0 : result.mRecalls.back();
+    result.mAP = average(result.mRecalls, result.mPrecisions);
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Truth truth;
+    std::vector<Jfloat> thresholds;
+    std::vector<EvaluationRow> truthRows;
+    std::vector<EvaluationRow> predictions;
+    std::vector<std::pair<Jsize, Jsize>> ranges;
+
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    auto &&truthFile = InputFile((*v)[0]);
+    auto &&predictionFile = InputFile((*v)[1]);
+    auto &&list = std::string((v->getLength() > 2) ? (*v)[2] : THRESHOLDS);
+
+    for (Jsize begin = 0; begin < list.size();) {
+      auto end = std::min(list.find(',', begin), list.size());
+      auto &&threshold = std::strtof(list.substr(begin, end - begin).c_str(), nullptr);
+      if ((threshold <= 0) || (threshold > 1))
+        return -1;
+      thresholds.push_back(threshold);
+      begin = end + 1;
+    }
+
+    if (!load(truthFile, threads, false, truthRows)) {
+      Log::error(FORMAT_FAILED, (*v)[0]);
+      return 0;
+    }
+    if (!load(predictionFile, threads, true, predictions)) {
+      Log::error(FORMAT_FAILED, (*v)[1]);
+      return 0;
+    }
+
+    auto &&images = unique(truthRows, &EvaluationRow::mPath);
+    auto &&classes = unique(truthRows, &EvaluationRow::mLabel);
+    for (auto &&rows : {&truthRows, &predictions}) {
+      Parallel::forEach(threads, rows->size(), [&](Jsize i, Jint) {
+        auto &&one = (*rows)[i];
+        one.mImage = find(images, one.mPath);
+        one.mClass = find(classes, one.mLabel);
+      });
+    }
+
+    std::sort(truthRows.begin(), truthRows.end(),
+              [](const EvaluationRow &a, const EvaluationRow &b) {
+                return (a.mClass != b.mClass) ? (a.mClass < b.mClass) : (a.mImage < b.mImage);
+              });
+    predictions.erase(std::remove_if(predictions.begin(), predictions.end(),
+                                     [](const EvaluationRow &one) { return one.mClass < 0; }),
+                      predictions.end());
+    std::stable_sort(predictions.begin(), predictions.end(),
+                     [](const EvaluationRow &a, const EvaluationRow &b) {
+                       return (a.mClass != b.mClass) ? (a.mClass < b.mClass)
+                                                     : (a.mScore > b.mScore);
+                     });
+
+    auto &&padded = LabelImageBoxKernel::getPadded(truthRows.size());
+    truth.mImages.reserve(truthRows.size());
+    truth.mMinX.reserve(padded);
+    truth.mMinY.reserve(padded);
+    truth.mMaxX.reserve(padded);
+    truth.mMaxY.reserve(padded);
+    for (auto &&one : truthRows) {
+      truth.mImages.push_back(one.mImage);
+      truth.mMinX.push_back(one.mMinX);
+      truth.mMinY.push_back(one.mMinY);
+      truth.mMaxX.push_back(one.mMaxX);
+      truth.mMaxY.push_back(one.mMaxY);
+    }
+    for (auto &&column : {&truth.mMinX, &truth.mMinY, &truth.mMaxX, &truth.mMaxY})
+      column->resize(padded + LabelImageBoxKernel::LANES);
+
+    truth.mClasses.assign(classes.size() + 1, truthRows.size());
+    ranges.assign(classes.size(), {predictions.size(), predictions.size()});
+    for (Jsize i = truthRows.size(); i > 0; --i)
+      truth.mClasses[truthRows[i - 1].mClass] = i - 1;
+    for (Jsize i = predictions.size(); i > 0; --i)
+      ranges[predictions[i - 1].mClass].first = i - 1;
+    for (Jsize i = 0; i < predictions.size(); ++i)
+      ranges[predictions[i].mClass].second = i + 1;
+
+    auto &&curves = v->getOption(OPTION_CURVES);
+    auto &&results = std::vector<EvaluationResult>(classes.size() * thresholds.size());
+    auto &&matched = std::vector<std::vector<Jbool>>(threads);
+    auto &&ious = std::vector<std::vector<Jfloat>>(threads);
+    auto &&prog = Program(results.size());
+    Parallel::forEach(threads, results.size(), [&](Jsize i, Jint worker) {
+      auto &&cls = i / thresholds.size();
+      if (matched[worker].empty())
+        matched[worker].resize(truthRows.size());
+      evaluate(truth, predictions, ranges[cls], cls, thresholds[i % thresholds.size()],
+               matched[worker], ious[worker], results[i]);
+      if (curves == nullptr) {
+        results[i].mRecalls = std::vector<Jfloat>();
+        results[i].mPrecisions = std::vector<Jfloat>();
+      }
+      prog.updateOne();
+    });
+
+    printf(FORMAT_TABLE_HEAD, "label", "truth", "predict", "recall");
+    for (auto &&threshold : thresholds)
+      printf(FORMAT_TABLE_IOU, String::format(FORMAT_TABLE_NAME, threshold).c_str());
+    printf(FORMAT_TABLE_IOU, "mAP");
+    printf("\n");
+
+    auto &&means = std::vector<Jfloat>(thresholds.size());
+    for (Jsize i = 0; i < classes.size(); ++i) {
+      Jfloat mean = 0;
+      auto &&count = truth.mClasses[i + 1] - truth.mClasses[i];
+      auto &&label = std::string(classes[i]);
+
+      printf(FORMAT_TABLE_ROW, label.c_str(), static_cast<Jlong>(count),
+             static_cast<Jlong>(ranges[i].second - ranges[i].first),
+             results[i * thresholds.size()].mRecall);
+      for (Jsize j = 0; j < thresholds.size(); ++j) {
+        auto &&ap = results[i * thresholds.size() + j].mAP;
+        printf(FORMAT_TABLE_AP, ap);
+        mean += ap / static_cast<Jfloat>(thresholds.size());
+        means[j] += ap / static_cast<Jfloat>(classes.size());
+      }
+      printf(FORMAT_TABLE_AP, mean);
+      printf("\n");
+    }
+
+    Jfloat all = 0;
+    printf(FORMAT_TABLE_HEAD, "*", "", "", "");
+    for (auto &&mean : means) {
+      printf(FORMAT_TABLE_AP, mean);
+      all += mean / static_cast<Jfloat>(means.size());
+    }
+    printf(FORMAT_TABLE_AP, all);
+    printf("\n");
+
+    if (curves != nullptr) {
+      auto &&output = fopen(curves, MODEL_WRITER_ONLY);
+      for (Jsize i = 0; (output != nullptr) && (i < results.size()); ++i) {
+        auto &&label = std::string(classes[i / thresholds.size()]);
+        auto &&result = results[i];
+        for (Jsize j = 0; j < result.mRecalls.size(); ++j)
+          fprintf(output, FORMAT_CURVE, label.c_str(), thresholds[i % thresholds.size()],
+                  result.mRecalls[j], result.mPrecisions[j]);
+      }
+      if (output != nullptr)
+        fclose(output);
+    }
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(images.size()), static_cast<Jint>(truthRows.size()),
+              static_cast<Jint>(predictions.size()), all);
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_EVAL_HPP
@@ -0,0 +1,1040 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_EXPORT_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_EXPORT_HPP
+
+namespace tfutils {
+
+class LabelDictionary {
+private:
+  std::mutex mMutex;
+  std::map<std::string, Jint> mIds;
+  std::vector<std::string> mNames;
+
+public:
+  LabelDictionary() : mMutex(), mIds(), mNames() {}
+
+  Jint getId(const std::string &v) {
+    std::lock_guard<std::mutex> lock(this->mMutex);
+
+    auto &&it = this->mIds.find(v);
+    if (it != this->mIds.end())
+      return it->second;
+
+    this->mNames.push_back(v);
+    this->mIds.emplace(v, static_cast<Jint>(this->mNames.size()));
+    return static_cast<Jint>(this->mNames.size());
+  }
+
+  [[nodiscard]] const std::vector<std::string> &getNames() const { return this->mNames; }
+};
+
+class TextBuffer {
+private:
+  constexpr static Jint SIZE_NUMBER = 64;
+
+  std::string mBuffer;
+
+public:
+  TextBuffer() : mBuffer() {}
+
+  void clean() { this->mBuffer.clear(); }
+
+  TextBuffer &append(std::string_view v) {
+    this->mBuffer.append(v.data(), v.size());
+    return *this;
+  }
+
+  TextBuffer &append(Jchar v) {
+    this->mBuffer.push_back(v);
+    return *this;
+  }
+
+  TextBuffer &append(Jlong v) {
+    Jchar number[SIZE_NUMBER];
+    auto &&ret = std::to_chars(number, number + sizeof(number), v);
+    this->mBuffer.append(number, ret.ptr - number);
+    return *this;
+  }
+
+  TextBuffer &append(Jfloat v, Jint precision) {
+    Jchar number[SIZE_NUMBER];
+    auto &&ret =
+        std::to_chars(number, number + sizeof(number), v, std::chars_format::fixed, precision);
+    this->mBuffer.append(number, ret.ptr - number);
+    return *this;
+  }
+
+  [[nodiscard]] const std::string &getData() const { return this->mBuffer; }
+};
+
+class JsonWriter {
+private:
+  constexpr static Jsize SIZE_BUFFER = 1024 * 1024;
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jint SIZE_NUMBER = 64;
+
+  FILE *mFile;
+  Jbool mFailed;
+  std::string mBuffer;
+
+public:
+  explicit JsonWriter(const std::string &v) : mFile(), mFailed(), mBuffer() {
+    this->mFile = fopen(v.c_str(), MODEL_WRITER_ONLY);
+    this->mFailed = (this->mFile == nullptr);
+    this->mBuffer.reserve(SIZE_BUFFER);
+  }
+
+  JsonWriter(const JsonWriter &) = delete;
+
+  JsonWriter &operator=(const JsonWriter &) = delete;
+
+  ~JsonWriter() { this->close(); }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFile != nullptr); }
+
+  JsonWriter &raw(std::string_view v) {
+    this->mBuffer.append(v.data(), v.size());
+    if (this->mBuffer.size() >= SIZE_BUFFER)
+      this->flush();
+    return *this;
+  }
+
+  JsonWriter &string(std::string_view v) {
+    this->mBuffer.push_back('"');
+    for (auto &&c : v) {
+      if ((c == '"') || (c == '\\')) {
+        this->mBuffer.push_back('\\');
+        this->mBuffer.push_back(c);
+      } else if (static_cast<Jbyte>(c) < 0x20) {
+        this->mBuffer.append(String::format("\\u%04x", static_cast<Jint>(c)));
+      } else {
+        this->mBuffer.push_back(c);
+      }
+    }
+    this->mBuffer.push_back('"');
+    return this->raw(std::string_view());
+  }
+
+  JsonWriter &number(Jlong v) { return this->raw(std::to_string(v)); }
+
+  // Shortest text that reads back as the same float.
+  JsonWriter &number(Jfloat v) {
+    Jchar number[SIZE_NUMBER];
+    auto &&ret = std::to_chars(number, number + sizeof(number), v);
+    return this->raw(std::string_view(number, ret.ptr - number));
+  }
+
+  void flush() {
+    if ((this->mFile != nullptr) && (!this->mBuffer.empty()))
+      this->mFailed =
+          (fwrite(this->mBuffer.data(), this->mBuffer.size(), 1, this->mFile) != 1) ||
+          this->mFailed;
+    this->mBuffer.clear();
+  }
+
+  // Writes out what is buffered and closes the file; false if anything failed.
+  Jbool close() {
+    this->flush();
+    if (this->mFile != nullptr)
+      this->mFailed = (fclose(this->mFile) != 0) || this->mFailed;
+    this->mFile = nullptr;
+    return !this->mFailed;
+  }
+};
+
+enum JsonToken : Jint {
+  JSON_END,
+  JSON_ERROR,
+  JSON_OBJECT_BEGIN,
+  JSON_OBJECT_END,
+  JSON_ARRAY_BEGIN,
+  JSON_ARRAY_END,
+  JSON_KEY,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_LITERAL,
+};
+
+class JsonReader {
+private:
+  constexpr static Jsize SIZE_BUFFER = 64 * 1024;
+  constexpr static Juint SURROGATE_HIGH = 0xd800;
+  constexpr static Juint SURROGATE_LOW = 0xdc00;
+  constexpr static Juint SURROGATE_LAST = 0xdfff;
+  constexpr static Juint UNICODE_REPLACEMENT = 0xfffd;
+  constexpr static Jchar MODEL_READER_ONLY[] = "rb";
+
+  FILE *mFile;
+  Jchar mBuffer[SIZE_BUFFER];
+  Jsize mPosition;
+  Jsize mLength;
+  std::string mValue;
+
+  Jint peek() {
+    if (this->mPosition < this->mLength)
+      return static_cast<Jbyte>(this->mBuffer[this->mPosition]);
+    if (this->mFile == nullptr)
+      return EOF;
+
+    this->mPosition = 0;
+    this->mLength = fread(this->mBuffer, 1, sizeof(this->mBuffer), this->mFile);
+    if (this->mLength == 0)
+      return EOF;
+    return static_cast<Jbyte>(this->mBuffer[this->mPosition]);
+  }
+
+  Jint get() {
+    auto &&ret = this->peek();
+    if (ret != EOF)
+      ++this->mPosition;
+    return ret;
+  }
+
+  Jint skipSpace() {
+    auto c = this->peek();
+    while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == ',') || (c == ':')) {
+      ++this->mPosition;
+      c = this->peek();
+    }
+    return c;
+  }
+
+  static void utf8(std::string &out, Juint v) {
+    if (v < 0x80) {
+      out.push_back(static_cast<Jchar>(v));
+    } else if (v < 0x800) {
+      out.push_back(static_cast<Jchar>(0xc0u | (v >> 6u)));
+      out.push_back(static_cast<Jchar>(0x80u | (v & 0x3fu)));
+    } else if (v < 0x10000) {
+      out.push_back(static_cast<Jchar>(0xe0u | (v >> 12u)));
+      out.push_back(static_cast<Jchar>(0x80u | ((v >> 6u) & 0x3fu)));
+      out.push_back(static_cast<Jchar>(0x80u | (v & 0x3fu)));
+    } else {
+      out.push_back(static_cast<Jchar>(0xf0u | (v >> 18u)));
+      out.push_back(static_cast<Jchar>(0x80u | ((v >> 12u) & 0x3fu)));
+      out.push_back(static_cast<Jchar>(0x80u | ((v >> 6u) & 0x3fu)));
+      out.push_back(static_cast<Jchar>(0x80u | (v & 0x3fu)));
+    }
+  }
+
+  // A surrogate pair decodes to one code point; a surrogate alone becomes U+FFFD.
+  Jbool string() {
+    Jint c = 0;
+    Juint high = 0;
+    Jchar hex[5] = {};
+
+    this->mValue.clear();
+    while ((c = this->get()) != '"') {
+      if (c == EOF)
+        return false;
+      if ((high != 0) && ((c != '\\') || (this->peek() != 'u'))) {
+        utf8(this->mValue, UNICODE_REPLACEMENT);
+        high = 0;
+      }
+      if (c != '\\') {
+        this->mValue.push_back(static_cast<Jchar>(c));
+        continue;
+      }
+
+      c = this->get();
+      if (c == 'n')
+        this->mValue.push_back('\n');
+      else if (c == 't')
+        this->mValue.push_back('\t');
+      else if (c == 'r')
+        this->mValue.push_back('\r');
+      else if (c == 'b')
+        this->mValue.push_back('\b');
+      else if (c == 'f')
+        this->mValue.push_back('\f');
+      else if (c == 'u') {
+        for (auto &&one : {0, 1, 2, 3})
+          hex[one] = static_cast<Jchar>(this->get());
+        auto &&code = static_cast<Juint>(std::strtoul(hex, nullptr, 16));
+        if ((high != 0) && (code >= SURROGATE_LOW) && (code <= SURROGATE_LAST)) {
+          utf8(this->mValue, 0x10000u + ((high - SURROGATE_HIGH) << 10u) + (code - SURROGATE_LOW));
+          high = 0;
+          continue;
+        }
+        if (high != 0)
+          utf8(this->mValue, UNICODE_REPLACEMENT);
+        high = 0;
+        if ((code >= SURROGATE_HIGH) && (code < SURROGATE_LOW))
+          high = code;
+        else if ((code >= SURROGATE_LOW) && (code <= SURROGATE_LAST))
+          utf8(this->mValue, UNICODE_REPLACEMENT);
+        else
+          utf8(this->mValue, code);
+      } else if (c != EOF)
+        this->mValue.push_back(static_cast<Jchar>(c));
+    }
+    if (high != 0)
+      utf8(this->mValue, UNICODE_REPLACEMENT);
+    return true;
+  }
+
+public:
+  explicit JsonReader(const std::string &v)
+      : mFile(), mBuffer(), mPosition(), mLength(), mValue() {
+    this->mFile = fopen(v.c_str(), MODEL_READER_ONLY);
+  }
+
+  JsonReader(const JsonReader &) = delete;
+
+  JsonReader &operator=(const JsonReader &) = delete;
+
+  ~JsonReader() {
+    if (this->mFile != nullptr)
+      fclose(this->mFile);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFile != nullptr); }
+
+  [[nodiscard]] const std::string &getValue() const { return this->mValue; }
+
+  [[nodiscard]] Jlong getLong() const { return std::strtoll(this->mValue.c_str(), nullptr, 10); }
+
+  [[nodiscard]] Jfloat getFloat() const { return std::strtof(this->mValue.c_str(), nullptr); }
+
+  JsonToken next() {
+    auto &&c = this->skipSpace();
+    if (c == EOF)
+      return JSON_END;
+
+    ++this->mPosition;
+    if (c == '{')
+      return JSON_OBJECT_BEGIN;
+    if (c == '}')
+      return JSON_OBJECT_END;
+    if (c == '[')
+      return JSON_ARRAY_BEGIN;
+    if (c == ']')
+      return JSON_ARRAY_END;
+
+    if (c == '"') {
+      if (!this->string())
+        return JSON_ERROR;
+      while ((this->peek() == ' ') || (this->peek() == '\t') || (this->peek() == '\r') ||
+             (this->peek() == '\n'))
+        ++this->mPosition;
+      return (this->peek() == ':') ? JSON_KEY : JSON_STRING;
+    }
+
+    this->mValue.assign(1, static_cast<Jchar>(c));
+    for (c = this->peek(); (c != EOF) && (strchr(",:]} \t\r\n", c) == nullptr); c = this->peek())
+      this->mValue.push_back(static_cast<Jchar>(this->get()));
+    if ((this->mValue[0] == '-') || ((this->mValue[0] >= '0') && (this->mValue[0] <= '9')))
+      return JSON_NUMBER;
+    return JSON_LITERAL;
+  }
+
+  Jbool skip(JsonToken v) {
+    Jint depth = 0;
+
+    do {
+      if ((v == JSON_OBJECT_BEGIN) || (v == JSON_ARRAY_BEGIN))
+        ++depth;
+      else if ((v == JSON_OBJECT_END) || (v == JSON_ARRAY_END))
+        --depth;
+      else if ((v == JSON_END) || (v == JSON_ERROR))
+        return false;
+
+      if (depth > 0)
+        v = this->next();
+    } while (depth > 0);
+    return true;
+  }
+
+  template <class Fun> Jbool forEachKey(Fun &&fun) {
+    JsonToken token = JSON_END;
+
+    while ((token = this->next()) == JSON_KEY) {
+      auto key = this->mValue;
+      if (!fun(key, this->next()))
+        return false;
+    }
+    return (token == JSON_OBJECT_END);
+  }
+
+  template <class Fun> Jbool forEachItem(Fun &&fun) {
+    JsonToken token = JSON_END;
+
+    while (((token = this->next()) != JSON_ARRAY_END) && (token != JSON_END) &&
+           (token != JSON_ERROR)) {
+      if (!fun(token))
+        return false;
+    }
+    return (token == JSON_ARRAY_END);
+  }
+};
+
+class CocoBox {
+public:
+  std::string mLabel;
+  Jfloat mX;
+  Jfloat mY;
+  Jfloat mWidth;
+  Jfloat mHeight;
+
+  CocoBox() : mLabel(), mX(), mY(), mWidth(), mHeight() {}
+};
+
+class CocoImage {
+public:
+  Jlong mId;
+  std::string mKey;
+  std::string mName;
+  std::string mPath;
+  Jint mWidth;
+  Jint mHeight;
+  std::vector<CocoBox> mBoxes;
+
+  CocoImage() : mId(), mKey(), mName(), mPath(), mWidth(), mHeight(), mBoxes() {}
+};
+
+class TensorflowCocoExport : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_BLOCK = 1024;
+  constexpr static Jsize SIZE_COPY = 1024 * 1024;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar SURRFIX_TEMP[] = ".annotations";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar OPTION_ROOT[] = "root";
+  constexpr static Jchar SUPERCATEGORY[] = "none";
+
+  constexpr static Jchar FORMAT_UNSIZED[] = "file: %s, image size unknown, bbox left normalized";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, open failed";
+  constexpr static Jchar FORMAT_WRITE[] = "file: %s, write failed";
+  constexpr static Jchar FORMAT_DONE[] = "images: %lld, annotations: %lld, categories: %d";
+
+  LabelDictionary mLabels;
+  Jlong mImages;
+  Jlong mAnnotations;
+
+  static void fromXml(const std::string &path, CocoImage &image) {
+    auto &&xml = LabelImageXML(path);
+
+    image.mName = xml.getFilename().empty()
+                      ? std::filesystem::path(path).replace_extension().filename().string()
+                      : xml.getFilename();
+    image.mWidth = xml.getSize().getWidth();
+    image.mHeight = xml.getSize().getHeight();
+    for (auto &&object : xml.getObjects()) {
+      auto &&box = object.getBndbox();
+      image.mBoxes.emplace_back();
+      image.mBoxes.back().mLabel = object.getName();
+      image.mBoxes.back().mX = static_cast<Jfloat>(std::min(box.getMinX(), box.getMaxX()));
+      image.mBoxes.back().mY = static_cast<Jfloat>(std::min(box.getMinY(), box.getMaxY()));
+      image.mBoxes.back().mWidth = static_cast<Jfloat>(std::abs(box.getMaxX() - box.getMinX()));
+      image.mBoxes.back().mHeight = static_cast<Jfloat>(std::abs(box.getMaxY() - box.getMinY()));
+    }
+  }
+
+  static void probe(CocoImage &image, ImageProbe &probe) {
+    Jint width = 0;
+    Jint height = 0;
+
+    if ((!image.mPath.empty()) && probe.probe(image.mPath, width, height)) {
+      image.mWidth = width;
+      image.mHeight = height;
+    }
+  }
+
+  // CSV boxes are normalized; images seen in an earlier block still need this.
+  static void scale(CocoImage &image) {
+    auto &&scaleX = (image.mWidth > 0) ? static_cast<Jfloat>(image.mWidth) : 1.0f;
+    auto &&scaleY = (image.mHeight > 0) ? static_cast<Jfloat>(image.mHeight) : 1.0f;
+    for (auto &&box : image.mBoxes) {
+      box.mX *= scaleX;
+      box.mY *= scaleY;
+      box.mWidth *= scaleX;
+      box.mHeight *= scaleY;
+    }
+  }
+
+  void write(std::vector<CocoImage> &images, JsonWriter &out, JsonWriter &annotations) {
+    for (auto &&image : images) {
+      if (image.mId == 0) {
+        image.mId = ++this->mImages;
+        out.raw((image.mId == 1) ? "{\"id\":" : ",{\"id\":").number(image.mId);
+        out.raw(",\"file_name\":").string(image.mName);
+        out.raw(",\"width\":").number(static_cast<Jlong>(image.mWidth));
+        out.raw(",\"height\":").number(static_cast<Jlong>(image.mHeight)).raw("}");
+      }
+
+      for (auto &&box : image.mBoxes) {
+        auto &&id = ++this->mAnnotations;
+        auto &&category = this->mLabels.getId(box.mLabel);
+        annotations.raw((id == 1) ? "{\"id\":" : ",{\"id\":").number(id);
+        annotations.raw(",\"image_id\":").number(image.mId);
+        annotations.raw(",\"category_id\":").number(static_cast<Jlong>(category));
+        annotations.raw(",\"bbox\":[").number(box.mX).raw(",").number(box.mY);
+        annotations.raw(",").number(box.mWidth).raw(",").number(box.mHeight).raw("]");
+        annotations.raw(",\"area\":").number(box.mWidth * box.mHeight);
+        annotations.raw(",\"iscrowd\":0}");
+      }
+    }
+  }
+
+  void exportXml(const std::filesystem::path &in, Jint threads, JsonWriter &out,
+                 JsonWriter &annotations) {
+    std::vector<std::string> paths;
+    std::vector<CocoImage> images;
+    UP<File> file(new File());
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in))
+        paths.push_back(one->getAbstractPath());
+      std::sort(paths.begin(), paths.end());
+    }
+
+    auto &&prog = Program(paths.size());
+    for (Jsize begin = 0; begin < paths.size(); begin += SIZE_BLOCK) {
+      auto end = std::min(paths.size(), begin + SIZE_BLOCK);
+      images.resize(end - begin);
+      Parallel::forEach(threads, end - begin, [&](Jsize i, Jint) {
+        fromXml(paths[begin + i], images[i]);
+        prog.updateOne();
+      });
+      this->write(images, out, annotations);
+      images.clear();
+    }
+  }
+
+  Jbool exportCsv(const std::string &in, const Jchar *root, Jint threads, JsonWriter &out,
+                  JsonWriter &annotations) {
+    Jsize current = 0;
+    TFCSVRow row;
+    std::string buffer;
+    std::vector<CocoImage> images;
+    std::string_view line;
+    std::map<std::string, CocoImage, std::less<>> seen;
+    std::map<std::string, Jsize, std::less<>> pending;
+
+    // Streamed a line at a time; only the keys of images already written are kept.
+    auto &&file = LineReader(in);
+    if (!file.isOpen())
+      return false;
+
+    auto &&probes = std::vector<ImageProbe>(threads);
+    auto &&flush = [&]() {
+      Parallel::forEach(threads, images.size(), [&](Jsize i, Jint worker) {
+        if (images[i].mId == 0)
+          probe(images[i], probes[worker]);
+        scale(images[i]);
+      });
+      for (auto &&image : images) {
+        if ((image.mId == 0) && ((image.mWidth <= 0) || (image.mHeight <= 0)))
+          Log::error(FORMAT_UNSIZED, image.mName.c_str());
+      }
+
+      this->write(images, out, annotations);
+      for (auto &&image : images) {
+        auto &&one = seen[image.mKey];
+        one.mId = image.mId;
+        one.mWidth = image.mWidth;
+        one.mHeight = image.mHeight;
+      }
+      images.clear();
+      pending.clear();
+    };
+
+    while (file.next(line)) {
+      if (!TFCSV::parseLine(line, row, buffer))
+        continue;
+
+      auto &&path = TFCSV::field(line, 1);
+      if (images.empty() || (images[current].mKey != path)) {
+        auto &&it = seen.find(path);
+        auto &&waiting = pending.find(path);
+        if (waiting != pending.end()) {
+          current = waiting->second;
+        } else {
+          if (images.size() >= SIZE_BLOCK)
+            flush();
+
+          current = images.size();
+          images.emplace_back();
+          auto &&image = images.back();
+          image.mKey = path;
+          if (it != seen.end()) {
+            image.mId = it->second.mId;
+            image.mWidth = it->second.mWidth;
+            image.mHeight = it->second.mHeight;
+          } else {
+            auto &&mark = path.find(TFCSVRow::SYMBOL_PATH);
+            auto &&local = (mark == std::string_view::npos) ? path : path.substr(mark + 1);
+            image.mName = std::filesystem::path(std::string(local)).filename().string();
+            if (root != nullptr)
+              image.mPath = std::string(root) + std::string(local);
+            pending.emplace(path, current);
+          }
+        }
+      }
+
+      auto &&image = images[current];
+      image.mBoxes.emplace_back();
+      image.mBoxes.back().mLabel = row.getTarget();
+      image.mBoxes.back().mX = std::min(row.getX1(), row.getX3());
+      image.mBoxes.back().mY = std::min(row.getY1(), row.getY3());
+      image.mBoxes.back().mWidth = std::abs(row.getX3() - row.getX1());
+      image.mBoxes.back().mHeight = std::abs(row.getY3() - row.getY1());
+    }
+    flush();
+    return !file.isFailed();
+  }
+
+  static Jbool append(JsonWriter &out, const std::string &path) {
+    Jsize retLen = 0;
+    std::vector<Jchar> buffer(SIZE_COPY);
+
+    auto &&in = fopen(path.c_str(), "rb");
+    if (in == nullptr)
+      return false;
+
+    while ((retLen = fread(buffer.data(), 1, buffer.size(), in)) > 0)
+      out.raw(std::string_view(buffer.data(), retLen));
+    auto &&ret = (ferror(in) == 0);
+    fclose(in);
+    return ret;
+  }
+
+public:
+  explicit TensorflowCocoExport(const Jchar *v)
+      : AbstractCommand(v), mLabels(), mImages(), mAnnotations() {}
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&output = std::string((*v)[1]);
+    auto &&temp = output + SURRFIX_TEMP;
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    auto &&out = JsonWriter(output);
+    auto &&annotations = JsonWriter(temp);
+    if ((!out.isOpen()) || (!annotations.isOpen())) {
+      Log::error(FORMAT_FAILED, output.c_str());
+      File::remove(temp);
+      return -1;
+    }
+
+    Jbool ret = true;
+    out.raw("{\"images\":[");
+    if (Gzip::getExtension(in) == SURRFIX_CSV) {
+      ret = this->exportCsv(in.string(), v->getOption(OPTION_ROOT), threads, out, annotations);
+      if (!ret)
+        Log::error(FORMAT_FAILED, in.string().c_str());
+    } else {
+      this->exportXml(in, threads, out, annotations);
+    }
+
+    // The annotations wait in temp until every image is written.
+    auto &&closed = annotations.close();
+    out.raw("],\"annotations\":[");
+    if ((!closed) || (!append(out, temp))) {
+      Log::error(FORMAT_WRITE, temp.c_str());
+      ret = false;
+    }
+    File::remove(temp);
+
+    out.raw("],\"categories\":[");
+    auto &&names = this->mLabels.getNames();
+    for (Jsize i = 0; i < names.size(); ++i) {
+      out.raw((i == 0) ? "{\"id\":" : ",{\"id\":").number(static_cast<Jlong>(i + 1));
+      out.raw(",\"name\":").string(names[i]);
+      out.raw(",\"supercategory\":").string(SUPERCATEGORY).raw("}");
+    }
+    out.raw("]}\n");
+    if (!out.close()) {
+      Log::error(FORMAT_WRITE, output.c_str());
+      ret = false;
+    }
+
+    Log::info(FORMAT_DONE, this->mImages, this->mAnnotations, static_cast<Jint>(names.size()));
+    return ret ? 0 : -1;
+  }
+};
+
+class TensorflowCocoImport : public AbstractCommand {
+private:
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar KEY_IMAGES[] = "images";
+  constexpr static Jchar KEY_ANNOTATIONS[] = "annotations";
+  constexpr static Jchar KEY_CATEGORIES[] = "categories";
+  constexpr static Jchar KEY_ID[] = "id";
+  constexpr static Jchar KEY_IMAGE_ID[] = "image_id";
+  constexpr static Jchar KEY_CATEGORY_ID[] = "category_id";
+  constexpr static Jchar KEY_FILE_NAME[] = "file_name";
+  constexpr static Jchar KEY_WIDTH[] = "width";
+  constexpr static Jchar KEY_HEIGHT[] = "height";
+  constexpr static Jchar KEY_NAME[] = "name";
+  constexpr static Jchar KEY_BBOX[] = "bbox";
+
+  constexpr static Jchar DATABASE[] = "Unknown";
+  constexpr static Jchar POSE[] = "Unspecified";
+  constexpr static Jint DEPTH = 3;
+
+  constexpr static Jchar FORMAT_INVALID[] = "file: %s, invalid json";
+  constexpr static Jchar FORMAT_DONE[] = "images: %d, annotations: %lld, skipped: %lld";
+
+  class Annotation {
+  public:
+    Jlong mImage;
+    Jlong mCategory;
+    Jfloat mBox[4];
+
+    Annotation() : mImage(), mCategory(), mBox() {}
+  };
+
+  class Image {
+  public:
+    Jlong mId;
+    std::string mName;
+    Jint mWidth;
+    Jint mHeight;
+
+    Image() : mId(), mName(), mWidth(), mHeight() {}
+  };
+
+  static Jbool readImage(JsonReader &reader, Image &image) {
+    return reader.forEachKey([&](const std::string &key, JsonToken token) {
+      if (key == KEY_ID)
+        image.mId = reader.getLong();
+      else if (key == KEY_FILE_NAME)
+        image.mName = reader.getValue();
+      else if (key == KEY_WIDTH)
+        image.mWidth = static_cast<Jint>(reader.getLong());
+      else if (key == KEY_HEIGHT)
+        image.mHeight = static_cast<Jint>(reader.getLong());
+      else
+        return reader.skip(token);
+      return true;
+    });
+  }
+
+  static Jbool readAnnotation(JsonReader &reader, Annotation &annotation) {
+    return reader.forEachKey([&](const std::string &key, JsonToken token) {
+      Jint i = 0;
+
+      if (key == KEY_IMAGE_ID)
+        annotation.mImage = reader.getLong();
+      else if (key == KEY_CATEGORY_ID)
+        annotation.mCategory = reader.getLong();
+      else if ((key == KEY_BBOX) && (token == JSON_ARRAY_BEGIN))
+        return reader.forEachItem([&](JsonToken) {
+          if (i < 4)
+            annotation.mBox[i++] = reader.getFloat();
+          return true;
+        });
+      else
+        return reader.skip(token);
+      return true;
+    });
+  }
+
+  static Jbool readCategory(JsonReader &reader, std::map<Jlong, std::string> &categories) {
+    Jlong id = 0;
+    std::string name;
+
+    auto &&ret = reader.forEachKey([&](const std::string &key, JsonToken token) {
+      if (key == KEY_ID)
+        id = reader.getLong();
+      else if (key == KEY_NAME)
+        name = reader.getValue();
+      else
+        return reader.skip(token);
+      return true;
+    });
+    categories[id] = name;
+    return ret;
+  }
+
+  static void write(const std::string &out, const Image &image,
+                    const std::vector<Annotation> &annotations,
+                    const std::map<Jlong, std::string> &categories, Jlong &skipped) {
+    LabelImageXMLSize size;
+    LabelImageXMLSource source;
+
+    auto &&xml = make<LabelImageXML>();
+    auto &&name = std::filesystem::path(image.mName).filename();
+
+    size.setWidth(image.mWidth);
+    size.setHeight(image.mHeight);
+    size.setDepth(DEPTH);
+    source.setDatabase(DATABASE);
+    xml->setFolder(std::filesystem::path(out).filename().string());
+    xml->setFilename(name.string());
+    xml->setPath(image.mName);
+    xml->setSource(source);
+    xml->setSize(size);
+
+    for (auto &&one : annotations) {
+      LabelImageXMLObject object;
+      LabelImageXMLBndbox box;
+
+      auto &&category = categories.find(one.mCategory);
+      if (category == categories.end()) {
+        ++skipped;
+        continue;
+      }
+
+      box.setMinX(static_cast<Jint>(std::lround(one.mBox[0])));
+      box.setMinY(static_cast<Jint>(std::lround(one.mBox[1])));
+      box.setMaxX(static_cast<Jint>(std::lround(one.mBox[0] + one.mBox[2])));
+      box.setMaxY(static_cast<Jint>(std::lround(one.mBox[1] + one.mBox[3])));
+      object.setName(category->second);
+      object.setPose(POSE);
+      object.setBndbox(box);
+      xml->addObject(object);
+    }
+
+    auto &&path = std::filesystem::path(out) / name.replace_extension(SURRFIX);
+    LabelImageXMLExporter(xml, path.string()).exported();
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jlong skipped = 0;
+    std::vector<Image> images;
+    std::vector<Annotation> annotations;
+    std::map<Jlong, std::string> categories;
+
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&in = std::string((*v)[0]);
+    auto &&out = std::string((*v)[1]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    auto &&reader = JsonReader(in);
+    if ((!reader.isOpen()) || (reader.next() != JSON_OBJECT_BEGIN)) {
+      Log::error(FORMAT_INVALID, in.c_str());
+      return -1;
+    }
+
+    // No XML can be written before the whole file is read: the annotations of an image may
+    // be anywhere in its array and the categories usually come last, as coco-export writes
+    // them. Only ids, names and boxes are kept, a few dozen bytes per annotation.
+    auto &&ret = reader.forEachKey([&](const std::string &key, JsonToken token) {
+      if (token != JSON_ARRAY_BEGIN)
+        return reader.skip(token);
+
+      return reader.forEachItem([&](JsonToken item) {
+        if (item != JSON_OBJECT_BEGIN)
+          return reader.skip(item);
+        if (key == KEY_IMAGES) {
+          images.emplace_back();
+          return readImage(reader, images.back());
+        }
+        if (key == KEY_ANNOTATIONS) {
+          annotations.emplace_back();
+          return readAnnotation(reader, annotations.back());
+        }
+        if (key == KEY_CATEGORIES)
+          return readCategory(reader, categories);
+        return reader.skip(item);
+      });
+    });
+    if (!ret) {
+      Log::error(FORMAT_INVALID, in.c_str());
+      return -1;
+    }
+
+    std::sort(images.begin(), images.end(),
+              [](const Image &a, const Image &b) { return a.mId < b.mId; });
+    std::stable_sort(annotations.begin(), annotations.end(),
+                     [](const Annotation &a, const Annotation &b) { return a.mImage < b.mImage; });
+    if (!File::isExist(out))
+      std::filesystem::create_directories(out);
+
+    auto &&counts = std::vector<Jlong>(threads);
+    auto &&prog = Program(images.size());
+    Parallel::forEach(threads, images.size(), [&](Jsize i, Jint worker) {
+      auto &&id = images[i].mId;
+      auto &&lower = std::lower_bound(
+          annotations.begin(), annotations.end(), id,
+          [](const Annotation &a, Jlong b) { return a.mImage < b; });
+      auto &&upper = std::upper_bound(
+          lower, annotations.end(), id, [](Jlong a, const Annotation &b) { return a < b.mImage; });
+
+      write(out, images[i], std::vector<Annotation>(lower, upper), categories, counts[worker]);
+      prog.updateOne();
+    });
+
+    for (auto &&count : counts)
+      skipped += count;
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(images.size()),
+              static_cast<Jlong>(annotations.size()) - skipped, skipped);
+    return 0;
+  }
+};
+
+class TensorflowYolo : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_BLOCK = 1024;
+  constexpr static Jint PRECISION = 6;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_TEXT[] = ".txt";
+  constexpr static Jchar CLASSES[] = "classes.txt";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar FORMAT_UNSIZED[] = "file: %s-%s-%dx%d, skipped";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, write failed";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, written: %d, boxes: %lld, classes: %d";
+
+  class Image {
+  public:
+    std::string mName;
+    LabelImageXMLSize mSize;
+    std::vector<std::pair<std::string, LabelImageXMLBndbox>> mObjects;
+    std::vector<Jint> mClasses;
+
+    Image() : mName(), mSize(), mObjects(), mClasses() {}
+  };
+
+  static void load(const std::string &path, Image &image) {
+    auto &&xml = LabelImageXML(path);
+
+    image.mName = std::filesystem::path(path).filename().string();
+    image.mSize = xml.getSize();
+    image.mObjects.clear();
+    for (auto &&object : xml.getObjects())
+      image.mObjects.emplace_back(object.getName(), object.getBndbox());
+  }
+
+  static Jbool save(const std::string &path, const std::string &v) {
+    auto &&fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+
+    auto &&ret = (write(fd, v.data(), v.size()) == static_cast<ssize_t>(v.size()));
+    close(fd);
+    return ret;
+  }
+
+  static Jbool format(const std::string &out, const Image &image, TextBuffer &buffer) {
+    Jfloat v[8] = {};
+
+    buffer.clean();
+    for (Jsize i = 0; i < image.mObjects.size(); ++i) {
+      auto &&box = image.mObjects[i].second;
+      GoogleCloudCSVFormat::getPoints(image.mSize.getWidth(), image.mSize.getHeight(),
+                                      box.getMinX(), box.getMinY(), box.getMaxX(),
+                                      box.getMaxY(), v);
+
+      buffer.append(static_cast<Jlong>(image.mClasses[i])).append(' ');
+      buffer.append((v[0] + v[4]) / 2, PRECISION).append(' ');
+      buffer.append((v[1] + v[5]) / 2, PRECISION).append(' ');
+      buffer.append(std::abs(v[4] - v[0]), PRECISION).append(' ');
+      buffer.append(std::abs(v[5] - v[1]), PRECISION).append('\n');
+    }
+
+    auto &&path = std::filesystem::path(out) / image.mName;
+    return save(path.replace_extension(SURRFIX_TEXT).string(), buffer.getData());
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jint written = 0;
+    Jlong boxes = 0;
+    std::string line;
+    std::string content;
+    std::vector<std::string> paths;
+    std::vector<Image> images;
+    LabelDictionary labels;
+    TextBuffer classes;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&in = std::string((*v)[0]);
+    auto &&out = std::string((*v)[1]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    if (File::isFile(in))
+      return -1;
+    if (!File::isExist(out))
+      std::filesystem::create_directories(out);
+
+    auto &&list = (std::filesystem::path(out) / CLASSES).string();
+    if (File::isExist(list) && File::read(list, content)) {
+      for (Jsize begin = 0; begin < content.size();) {
+        auto end = std::min(content.find('\n', begin), content.size());
+        line = content.substr(begin, end - begin);
+        if ((!line.empty()) && (line.back() == '\r'))
+          line.pop_back();
+        if (!line.empty())
+          labels.getId(line);
+        begin = end + 1;
+      }
+    }
+
+    for (auto &&one : file->getFilesInDirectory<SURRFIX>(in))
+      paths.push_back(one->getAbstractPath());
+    std::sort(paths.begin(), paths.end());
+
+    auto &&buffers = std::vector<TextBuffer>(threads);
+    auto &&results = std::vector<Jbyte>(SIZE_BLOCK);
+    auto &&prog = Program(paths.size());
+    for (Jsize begin = 0; begin < paths.size(); begin += SIZE_BLOCK) {
+      auto end = std::min(paths.size(), begin + SIZE_BLOCK);
+      images.resize(end - begin);
+      Parallel::forEach(threads, end - begin,
+                        [&](Jsize i, Jint) { load(paths[begin + i], images[i]); });
+
+      for (auto &&image : images) {
+        image.mClasses.clear();
+        for (auto &&object : image.mObjects)
+          image.mClasses.push_back(labels.getId(object.first) - 1);
+      }
+
+      Parallel::forEach(threads, images.size(), [&](Jsize i, Jint worker) {
+        auto &&image = images[i];
+        results[i] = 0;
+        if ((image.mSize.getWidth() > 0) && (image.mSize.getHeight() > 0))
+          results[i] = format(out, image, buffers[worker]) ? 1 : 2;
+        prog.updateOne();
+      });
+
+      for (Jsize i = 0; i < images.size(); ++i) {
+        auto &&image = images[i];
+        if (results[i] == 0) {
+          Log::error(FORMAT_UNSIZED, image.mName.c_str(), LabelImageXMLTarget::SIZE,
+                     image.mSize.getWidth(), image.mSize.getHeight());
+        } else if (results[i] == 2) {
+          Log::error(FORMAT_FAILED, image.mName.c_str());
+        } else {
+          ++written;
+          boxes += static_cast<Jlong>(image.mObjects.size());
+        }
+      }
+    }
+
+    for (auto &&name : labels.getNames())
+      classes.append(name).append('\n');
+    if (!save(list, classes.getData()))
+      Log::error(FORMAT_FAILED, list.c_str());
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(paths.size()), written, boxes,
+              static_cast<Jint>(labels.getNames().size()));
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_EXPORT_HPP
@@ -0,0 +1,515 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_EXTERNAL_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_EXTERNAL_HPP
+
+namespace tfutils {
+
+// Tournament tree for a k-way merge. Every inner node keeps the loser of its match, so
+// advancing the winner replays one path to the root: log2(k) comparisons per row. less(a, b)
+// orders sources by their current head and must put exhausted sources last.
+template <class Less> class LoserTree {
+private:
+  Jsize mCount;
+  std::vector<Jsize> mTree;
+  Less mLess;
+
+  // The sentinel mCount stands for a source ahead of every other while the tree is built.
+  [[nodiscard]] Jbool isBefore(Jsize a, Jsize b) const {
+    if (a == this->mCount)
+      return (b != this->mCount);
+    if (b == this->mCount)
+      return false;
+    return this->mLess(a, b);
+  }
+
+public:
+  LoserTree(Jsize count, Less less) : mCount(count), mTree(std::max<Jsize>(count, 1), count),
+                                      mLess(less) {
+    for (auto i = count; i > 0; --i)
+      this->replay(i - 1);
+  }
+
+  [[nodiscard]] Jsize getWinner() const { return this->mTree[0]; }
+
+  // Called after source's head changed, normally the winner's.
+  void replay(Jsize source) {
+    auto winner = source;
+
+    for (auto node = (source + this->mCount) / 2; node > 0; node /= 2) {
+      if (this->isBefore(this->mTree[node], winner))
+        std::swap(this->mTree[node], winner);
+    }
+    this->mTree[0] = winner;
+  }
+};
+
+class TensorflowMerge : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_MEBI = 1024 * 1024;
+  constexpr static Jsize SIZE_MEMORY = 1024;
+  constexpr static Jsize SIZE_FANIN = 128;
+  constexpr static Jsize SIZE_ENTRY = sizeof(std::pair<Jsize, Jsize>);
+
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar OPTION_MEMORY[] = "memory";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar FORMAT_RUN[] = "%s.run-%05d";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, open failed";
+  constexpr static Jchar FORMAT_READ[] = "file: %s, read failed";
+  constexpr static Jchar FORMAT_DONE[] = "file: %s, rows: %lld, duplicates: %lld, runs: %d";
+
+  Jint mRuns;
+  Jlong mRows;
+  Jlong mDuplicates;
+  std::string mOut;
+  std::vector<std::string> mFiles;
+
+  // Rows sort by image path, then target, then the whole row, so exact duplicates meet.
+  static Jbool isBefore(std::string_view a, std::string_view b) {
+    auto &&pathA = TFCSV::field(a, 1);
+    auto &&pathB = TFCSV::field(b, 1);
+    if (pathA != pathB)
+      return pathA < pathB;
+
+    auto &&targetA = TFCSV::field(a, 2);
+    auto &&targetB = TFCSV::field(b, 2);
+    if (targetA != targetB)
+      return targetA < targetB;
+    return a < b;
+  }
+
+  std::string getRun() {
+    return String::format(FORMAT_RUN, this->mOut.c_str(), this->mRuns++);
+  }
+
+  // Writes rows in order, skipping a row equal to the one written before it.
+  class Writer {
+  private:
+    OutputFile mFile;
+    std::string mLast;
+    Jlong mRows;
+    Jlong mDuplicates;
+
+  public:
+    explicit Writer(const std::string &path, Jbool compressed = false, Jint threads = 1)
+        : mFile(path, compressed, MODEL_WRITER_ONLY, threads), mLast(), mRows(), mDuplicates() {}
+
+    Writer(const Writer &) = delete;
+
+    Writer &operator=(const Writer &) = delete;
+
+    [[nodiscard]] Jbool isOpen() const { return this->mFile.isOpen(); }
+
+    [[nodiscard]] Jlong getRows() const { return this->mRows; }
+
+    [[nodiscard]] Jlong getDuplicates() const { return this->mDuplicates; }
+
+    void add(std::string_view row) {
+      if ((this->mRows > 0) && (row == this->mLast)) {
+        ++this->mDuplicates;
+        return;
+      }
+      this->mLast.assign(row.data(), row.size());
+      this->mFile.write(row);
+      this->mFile.write("\n", 1);
+      ++this->mRows;
+    }
+
+    Jbool close() { return this->mFile.close(); }
+  };
+
+  // Sorts the buffered rows with one slice per thread, then merges the slices pairwise.
+  static void sort(const std::string &lines, std::vector<std::pair<Jsize, Jsize>> &entries,
+                   Jint threads) {
+    auto &&less = [&lines](const std::pair<Jsize, Jsize> &a, const std::pair<Jsize, Jsize> &b) {
+      return isBefore(std::string_view(&lines[a.first], a.second),
+                      std::string_view(&lines[b.first], b.second));
+    };
+
+    auto &&slices = static_cast<Jsize>(std::max(threads, 1));
+    auto &&step = (entries.size() + slices - 1) / slices;
+    if (step == 0)
+      return;
+
+    Parallel::forEach(threads, slices, [&](Jsize slice, Jint) {
+      auto begin = std::min(slice * step, entries.size());
+      auto end = std::min(begin + step, entries.size());
+      std::sort(entries.begin() + begin, entries.begin() + end, less);
+    });
+    for (auto width = step; width < entries.size(); width *= 2) {
+      for (Jsize begin = 0; begin + width < entries.size(); begin += width * 2) {
+        auto end = std::min(begin + width * 2, entries.size());
+        std::inplace_merge(entries.begin() + begin, entries.begin() + begin + width,
+                           entries.begin() + end, less);
+      }
+    }
+  }
+
+  Jbool spill(const std::string &lines, std::vector<std::pair<Jsize, Jsize>> &entries,
+              Jint threads, std::vector<std::string> &runs) {
+    sort(lines, entries, threads);
+    runs.push_back(this->getRun());
+
+    auto &&out = Writer(runs.back());
+    if (!out.isOpen())
+      return false;
+    for (auto &&entry : entries)
+      out.add(std::string_view(&lines[entry.first], entry.second));
+    this->mDuplicates += out.getDuplicates();
+    return out.close();
+  }
+
+  // Reads every input once, cutting it into sorted runs that each fit half the budget.
+  Jbool split(Jsize memory, Jint threads, std::vector<std::string> &runs) {
+    std::string lines;
+    std::string_view line;
+    std::vector<std::pair<Jsize, Jsize>> entries;
+
+    auto &&budget = memory / 2;
+    lines.reserve(budget);
+    for (auto &&path : this->mFiles) {
+      auto &&in = LineReader(path);
+      if (!in.isOpen()) {
+        Log::error(FORMAT_FAILED, path.c_str());
+        return false;
+      }
+
+      while (in.next(line)) {
+        if (line.empty())
+          continue;
+        if ((!entries.empty()) &&
+            (lines.size() + line.size() + (entries.size() + 1) * SIZE_ENTRY > budget)) {
+          if (!this->spill(lines, entries, threads, runs))
+            return false;
+          lines.clear();
+          entries.clear();
+        }
+        entries.emplace_back(lines.size(), line.size());
+        lines.append(line);
+      }
+      if (in.isFailed()) {
+        Log::error(FORMAT_READ, path.c_str());
+        return false;
+      }
+    }
+    return entries.empty() || this->spill(lines, entries, threads, runs);
+  }
+
+  // Merges runs into out through a loser tree; every reader gets an equal share of memory.
+  Jbool merge(const std::vector<std::string> &runs, const std::string &out, Jsize memory,
+              Jbool compressed = false, Jint threads = 1) {
+    std::vector<UP<LineReader>> readers;
+    std::vector<std::string_view> heads(runs.size());
+    std::vector<Jbool> alive(runs.size());
+
+    auto size = std::max<Jsize>(memory / (runs.size() + 1), SIZE_MEBI / 16);
+    for (Jsize i = 0; i < runs.size(); ++i) {
+      readers.emplace_back(new LineReader(runs[i], size));
+      alive[i] = readers[i]->next(heads[i]);
+    }
+
+    auto &&writer = Writer(out, compressed, threads);
+    if (!writer.isOpen())
+      return false;
+
+    auto &&tree = LoserTree(runs.size(), [&heads, &alive](Jsize a, Jsize b) {
+      if (!alive[a] || !alive[b])
+        return alive[a] && !alive[b];
+      return isBefore(heads[a], heads[b]);
+    });
+    for (auto winner = tree.getWinner(); (winner < runs.size()) && alive[winner];
+         winner = tree.getWinner()) {
+      writer.add(heads[winner]);
+      alive[winner] = readers[winner]->next(heads[winner]);
+      tree.replay(winner);
+    }
+
+    this->mRows = writer.getRows();
+    this->mDuplicates += writer.getDuplicates();
+    auto &&ret = writer.close();
+    for (Jsize i = 0; i < runs.size(); ++i) {
+      if (readers[i]->isFailed()) {
+        Log::error(FORMAT_READ, runs[i].c_str());
+        ret = false;
+      }
+    }
+    return ret;
+  }
+
+  Jint execute(Jsize memory, Jint threads) {
+    std::vector<std::string> runs;
+
+    auto &&ret = this->split(memory, threads, runs);
+
+    // Too many runs to keep open at once are merged a group at a time first.
+    while (ret && (runs.size() > SIZE_FANIN)) {
+      std::vector<std::string> next;
+      for (Jsize begin = 0; ret && (begin < runs.size()); begin += SIZE_FANIN) {
+        auto end = std::min(begin + SIZE_FANIN, runs.size());
+        auto &&group = std::vector<std::string>(runs.begin() + begin, runs.begin() + end);
+        next.push_back(this->getRun());
+        ret = this->merge(group, next.back(), memory);
+        for (auto &&run : group)
+          File::remove(run);
+      }
+      runs.swap(next);
+    }
+
+    auto &&temp = this->mOut + SURRFIX_TEMP;
+    ret = ret && this->merge(runs, temp, memory, Gzip::isGzip(this->mOut), threads);
+    for (auto &&run : runs)
+      File::remove(run);
+    if (!ret || (rename(temp.c_str(), this->mOut.c_str()) != 0)) {
+      File::remove(temp);
+      return -1;
+    }
+
+    Log::info(FORMAT_DONE, this->mOut.c_str(), this->mRows, this->mDuplicates, this->mRuns);
+    return 0;
+  }
+
+public:
+  explicit TensorflowMerge(const Jchar *v)
+      : AbstractCommand(v), mRuns(), mRows(), mDuplicates(), mOut(), mFiles() {}
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    auto memory = SIZE_MEMORY;
+
+    if (v->getLength() < 2)
+      return -1;
+
+    this->mOut = (*v)[0];
+    for (Jint i = 1; i < v->getLength(); ++i)
+      this->mFiles.emplace_back((*v)[i]);
+
+    if (v->getOption(OPTION_MEMORY) != nullptr)
+      memory = std::max<Jsize>(std::strtoul(v->getOption(OPTION_MEMORY), nullptr, 10), 1);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    return this->execute(memory * SIZE_MEBI, threads);
+  }
+};
+
+// Two-pass external shuffle. Rows are scattered into on-disk buckets by a seeded random key,
+// then every bucket is shuffled in memory and appended in bucket order. The bucket count only
+// depends on the input size, so a seed gives the same output for any --memory or --threads.
+class TensorflowShuffle : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_MEBI = 1024 * 1024;
+  constexpr static Jsize SIZE_MEMORY = 1024;
+  constexpr static Jsize SIZE_BUCKET = 64 * SIZE_MEBI;
+  constexpr static Jsize SIZE_BUCKETS = 1000;
+  constexpr static Jsize SIZE_BUFFER = 64 * 1024;
+
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar OPTION_SEED[] = "seed";
+  constexpr static Jchar OPTION_MEMORY[] = "memory";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar FORMAT_BUCKET[] = "%s.bucket-%05d";
+  constexpr static Jchar FORMAT_PART[] = "%s.bucket-%05d-%05d";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, open failed";
+  constexpr static Jchar FORMAT_READ[] = "file: %s, read failed";
+  constexpr static Jchar FORMAT_DONE[] = "file: %s, rows: %lld, buckets: %d, seed: %llu";
+
+  Jlong mRows;
+  Jsize mSize;
+  uint64_t mSeed;
+  std::string mIn;
+  std::string mOut;
+  std::vector<std::string> mBuckets;
+  std::vector<Jsize> mSizes;
+
+  // Buckets grow past SIZE_BUCKET only to keep their count, and the open files, bounded.
+  [[nodiscard]] Jsize getBucket() const {
+    return std::max(SIZE_BUCKET, this->mSize / SIZE_BUCKETS);
+  }
+
+  // Every row of path goes to the bucket its random key picks; sizes gets the bytes of each.
+  static Jbool scatter(const std::string &path, const std::vector<std::string> &buckets,
+                       uint64_t seed, std::vector<Jsize> &sizes, Jlong &rows) {
+    std::string_view line;
+    std::vector<FILE *> files(buckets.size());
+    std::vector<std::vector<Jchar>> buffers(buckets.size());
+
+    auto &&in = LineReader(path);
+    if (!in.isOpen()) {
+      Log::error(FORMAT_FAILED, path.c_str());
+      return false;
+    }
+
+    auto ret = true;
+    sizes.assign(buckets.size(), 0);
+    for (Jsize i = 0; ret && (i < files.size()); ++i) {
+      files[i] = fopen(buckets[i].c_str(), MODEL_WRITER_ONLY);
+      if (files[i] == nullptr) {
+        Log::error(FORMAT_FAILED, buckets[i].c_str());
+        ret = false;
+        continue;
+      }
+      buffers[i].resize(SIZE_BUFFER);
+      setvbuf(files[i], buffers[i].data(), _IOFBF, buffers[i].size());
+    }
+
+    auto &&random = std::mt19937_64(seed);
+    while (ret && in.next(line)) {
+      if (line.empty())
+        continue;
+
+      auto &&index = random() % files.size();
+      fwrite(line.data(), line.size(), 1, files[index]);
+      fputc('\n', files[index]);
+      sizes[index] += line.size() + 1;
+      ++rows;
+    }
+    if (in.isFailed()) {
+      Log::error(FORMAT_READ, path.c_str());
+      ret = false;
+    }
+
+    for (auto &&file : files) {
+      if (file == nullptr)
+        continue;
+      ret = (fflush(file) == 0) && ret;
+      fclose(file);
+    }
+    return ret;
+  }
+
+  // The bucket count comes from the size on disk, which undercounts compressed input. A
+  // bucket that came out more than twice the size it was meant to have is scattered again
+  // into parts that take its place, so that gather never loads more than it budgeted for.
+  Jbool split() {
+    Jlong rows = 0;
+    std::vector<std::string> buckets;
+    std::vector<Jsize> sizes;
+
+    this->mSize = 0;
+    for (auto &&size : this->mSizes)
+      this->mSize += size;
+
+    auto &&bucket = this->getBucket();
+    for (Jsize i = 0; i < this->mBuckets.size(); ++i) {
+      if (this->mSizes[i] <= 2 * bucket) {
+        buckets.push_back(this->mBuckets[i]);
+        sizes.push_back(this->mSizes[i]);
+        continue;
+      }
+
+      std::vector<std::string> parts;
+      std::vector<Jsize> counted;
+      auto count = (this->mSizes[i] + bucket - 1) / bucket;
+      for (Jsize part = 0; part < count; ++part)
+        parts.emplace_back(String::format(FORMAT_PART, this->mOut.c_str(), i, part));
+
+      auto &&ret = scatter(this->mBuckets[i], parts, ~(this->mSeed + i), counted, rows);
+      File::remove(this->mBuckets[i]);
+      if (!ret) {
+        this->mBuckets.insert(this->mBuckets.end(), parts.begin(), parts.end());
+        return false;
+      }
+      buckets.insert(buckets.end(), parts.begin(), parts.end());
+      sizes.insert(sizes.end(), counted.begin(), counted.end());
+    }
+
+    this->mBuckets = move(buckets);
+    this->mSizes = move(sizes);
+    return true;
+  }
+
+  // Pass two: as many buckets as the budget allows are shuffled at once, then written in order.
+  Jbool gather(OutputFile &out, Jsize memory, Jint threads) {
+    auto largest = std::max<Jsize>(*std::max_element(this->mSizes.begin(), this->mSizes.end()), 1);
+    auto workers = std::min<Jsize>(std::max<Jsize>(memory / 2 / largest, 1), threads);
+    auto &&contents = std::vector<std::string>(workers);
+    auto &&rows = std::vector<std::vector<std::string_view>>(workers);
+    auto &&status = std::vector<Jbyte>(workers);
+
+    for (Jsize begin = 0; begin < this->mBuckets.size(); begin += workers) {
+      auto count = std::min(workers, this->mBuckets.size() - begin);
+
+      Parallel::forEach(static_cast<Jint>(count), count, [&](Jsize index, Jint) {
+        auto &&content = contents[index];
+        auto &&row = rows[index];
+        auto &&random = std::mt19937_64(this->mSeed + begin + index + 1);
+
+        row.clear();
+        status[index] = File::read(this->mBuckets[begin + index], content);
+        for (Jsize offset = 0, stop = 0; offset < content.size(); offset = stop + 1) {
+          stop = content.find('\n', offset);
+          if (stop == std::string::npos)
+            stop = content.size();
+          row.emplace_back(&content[offset], stop - offset);
+        }
+        std::shuffle(row.begin(), row.end(), random);
+      });
+
+      for (Jsize i = 0; i < count; ++i) {
+        if (!status[i])
+          return false;
+        for (auto &&line : rows[i]) {
+          out.write(line);
+          out.write("\n", 1);
+        }
+        File::remove(this->mBuckets[begin + i]);
+      }
+    }
+    return true;
+  }
+
+  Jint execute(Jsize memory, Jint threads) {
+    std::error_code error;
+
+    this->mSize = std::filesystem::file_size(this->mIn, error);
+    if (error) {
+      Log::error(FORMAT_FAILED, this->mIn.c_str());
+      return -1;
+    }
+
+    auto &&bucket = this->getBucket();
+    auto count = std::max<Jsize>((this->mSize + bucket - 1) / bucket, 1);
+    for (Jsize i = 0; i < count; ++i)
+      this->mBuckets.emplace_back(String::format(FORMAT_BUCKET, this->mOut.c_str(), i));
+
+    auto &&temp = this->mOut + SURRFIX_TEMP;
+    auto &&out = OutputFile(temp, Gzip::isGzip(this->mOut), MODEL_WRITER_ONLY, threads);
+    auto &&ret = out.isOpen() &&
+                 scatter(this->mIn, this->mBuckets, this->mSeed, this->mSizes, this->mRows) &&
+                 this->split() && this->gather(out, memory, threads);
+    ret = out.close() && ret;
+    for (auto &&path : this->mBuckets)
+      File::remove(path);
+    if (!ret || (rename(temp.c_str(), this->mOut.c_str()) != 0)) {
+      File::remove(temp);
+      return -1;
+    }
+
+    Log::info(FORMAT_DONE, this->mOut.c_str(), this->mRows,
+              static_cast<Jint>(this->mBuckets.size()),
+              static_cast<unsigned long long>(this->mSeed));
+    return 0;
+  }
+
+public:
+  explicit TensorflowShuffle(const Jchar *v)
+      : AbstractCommand(v), mRows(), mSize(), mSeed(), mIn(), mOut(), mBuckets(), mSizes() {}
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    auto memory = SIZE_MEMORY;
+
+    if (v->getLength() < 2)
+      return -1;
+
+    this->mIn = (*v)[0];
+    this->mOut = (*v)[1];
+    if (v->getOption(OPTION_SEED) != nullptr)
+      this->mSeed = std::strtoull(v->getOption(OPTION_SEED), nullptr, 10);
+    if (v->getOption(OPTION_MEMORY) != nullptr)
+      memory = std::max<Jsize>(std::strtoul(v->getOption(OPTION_MEMORY), nullptr, 10), 1);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    return this->execute(memory * SIZE_MEBI, threads);
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_EXTERNAL_HPP
@@ -0,0 +1,240 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_IMAGE_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_IMAGE_HPP
+
+namespace tfutils {
+
+class ImageProbe {
+private:
+  constexpr static Jint SIZE_WINDOW = 4096;
+  constexpr static Jint SIZE_PNG_HEADER = 24;
+
+  constexpr static Jbyte PNG_SIGNATURE[] = {0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a};
+  constexpr static Jbyte PNG_IHDR[] = {'I', 'H', 'D', 'R'};
+
+  constexpr static Jbyte JPEG_MARK = 0xff;
+  constexpr static Jbyte JPEG_SOI = 0xd8;
+  constexpr static Jbyte JPEG_EOI = 0xd9;
+  constexpr static Jbyte JPEG_SOS = 0xda;
+  constexpr static Jbyte JPEG_TEM = 0x01;
+  constexpr static Jbyte JPEG_RST0 = 0xd0;
+  constexpr static Jbyte JPEG_RST7 = 0xd7;
+  constexpr static Jbyte JPEG_SOF0 = 0xc0;
+  constexpr static Jbyte JPEG_SOF15 = 0xcf;
+  constexpr static Jbyte JPEG_DHT = 0xc4;
+  constexpr static Jbyte JPEG_JPG = 0xc8;
+  constexpr static Jbyte JPEG_DAC = 0xcc;
+
+  Jint mFd;
+  Jbyte mWindow[SIZE_WINDOW];
+
+  static Jint big16(const Jbyte *v) { return (v[0] << 8) | v[1]; }
+
+  static Jint big32(const Jbyte *v) {
+    return static_cast<Jint>((static_cast<Juint>(v[0]) << 24u) | (v[1] << 16u) | (v[2] << 8u) |
+                             v[3]);
+  }
+
+  Jint load(off_t offset, Jint len) {
+    return static_cast<Jint>(pread(this->mFd, this->mWindow, len, offset));
+  }
+
+  Jbool png(Jint len, Jint &width, Jint &height) {
+    if (len < SIZE_PNG_HEADER)
+      return false;
+    if (memcmp(&this->mWindow[12], PNG_IHDR, sizeof(PNG_IHDR)) != 0)
+      return false;
+
+    width = big32(&this->mWindow[16]);
+    height = big32(&this->mWindow[20]);
+    return true;
+  }
+
+  Jbool jpeg(Jint len, Jint &width, Jint &height) {
+    Jint pos = 2;
+    off_t base = 0;
+
+    while (true) {
+      if ((pos + 9) > len) {
+        base += pos;
+        len = this->load(base, SIZE_WINDOW);
+        pos = 0;
+        if (len < 9)
+          return false;
+      }
+
+      if (this->mWindow[pos] != JPEG_MARK)
+        return false;
+      while ((pos < (len - 1)) && (this->mWindow[pos + 1] == JPEG_MARK))
+        ++pos;
+
+      auto &&marker = this->mWindow[pos + 1];
+      if ((marker == JPEG_SOI) || (marker == JPEG_TEM) ||
+          ((marker >= JPEG_RST0) && (marker <= JPEG_RST7))) {
+        pos += 2;
+        continue;
+      }
+      if ((marker == JPEG_EOI) || (marker == JPEG_SOS))
+        return false;
+
+      if ((pos + 9) > len)
+        continue;
+
+      if ((marker >= JPEG_SOF0) && (marker <= JPEG_SOF15) && (marker != JPEG_DHT) &&
+          (marker != JPEG_JPG) && (marker != JPEG_DAC)) {
+        height = big16(&this->mWindow[pos + 5]);
+        width = big16(&this->mWindow[pos + 7]);
+        return true;
+      }
+
+      auto &&segment = big16(&this->mWindow[pos + 2]);
+      if (segment < 2)
+        return false;
+      pos += 2 + segment;
+    }
+  }
+
+public:
+  ImageProbe() : mFd(-1), mWindow() {}
+
+  Jbool probe(const std::string &v, Jint &width, Jint &height) {
+    Jbool ret = false;
+
+    this->mFd = open(v.c_str(), O_RDONLY);
+    if (this->mFd < 0)
+      return false;
+
+    auto &&len = this->load(0, SIZE_WINDOW);
+    if ((len >= static_cast<Jint>(sizeof(PNG_SIGNATURE))) &&
+        (memcmp(this->mWindow, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0))
+      ret = this->png(len, width, height);
+    else if ((len >= 2) && (this->mWindow[0] == JPEG_MARK) && (this->mWindow[1] == JPEG_SOI))
+      ret = this->jpeg(len, width, height);
+
+    close(this->mFd);
+    this->mFd = -1;
+    return ret;
+  }
+};
+
+class TensorflowVerify : public AbstractCommand {
+private:
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar FORMAT_UNREADABLE[] = "file: %s-%s-%s unreadable";
+  constexpr static Jchar FORMAT_SIZE[] = "file: %s-%s-%dx%d, image: %dx%d";
+  constexpr static Jchar FORMAT_BNDBOX[] = "file: %s-%s-%s (%d,%d,%d,%d) outside %dx%d";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, unreadable: %d, size: %d, bndbox: %d";
+
+  class Result {
+  public:
+    Jsize mIndex;
+    std::string mMessage;
+
+    Result(Jsize index, std::string message) : mIndex(index), mMessage(move(message)) {}
+  };
+
+  class Summary {
+  public:
+    Jint mUnreadable;
+    Jint mSize;
+    Jint mBndbox;
+    std::vector<Result> mResults;
+
+    Summary() : mUnreadable(), mSize(), mBndbox(), mResults() {}
+  };
+
+  static void verify(Jsize index, const std::string &path, const std::string &name,
+                     ImageProbe &probe, Summary &summary) {
+    Jint width = 0;
+    Jint height = 0;
+
+    auto &&xml = LabelImageXML(path);
+    auto &&image = LabelImageXMLImage::getPath(path, xml);
+
+    if (!probe.probe(image, width, height)) {
+      ++summary.mUnreadable;
+      summary.mResults.emplace_back(index, String::format(FORMAT_UNREADABLE, name.c_str(),
+                                                          LabelImageXMLTarget::PATH,
+                                                          image.c_str()));
+      return;
+    }
+
+    auto &&size = xml.getSize();
+    if ((size.getWidth() != width) || (size.getHeight() != height)) {
+      ++summary.mSize;
+      summary.mResults.emplace_back(
+          index, String::format(FORMAT_SIZE, name.c_str(), LabelImageXMLTarget::SIZE,
+                                size.getWidth(), size.getHeight(), width, height));
+    }
+
+    for (auto &&object : xml.getObjects()) {
+      auto &&box = object.getBndbox();
+      if ((box.getMinX() >= 0) && (box.getMinY() >= 0) && (box.getMaxX() <= width) &&
+          (box.getMaxY() <= height))
+        continue;
+
+      ++summary.mBndbox;
+      summary.mResults.emplace_back(
+          index, String::format(FORMAT_BNDBOX, name.c_str(), LabelImageXMLTarget::O_BNDBOX,
+                                object.getName().c_str(), box.getMinX(), box.getMinY(),
+                                box.getMaxX(), box.getMaxY(), width, height));
+    }
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Summary all;
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 1)
+      return -1;
+
+    auto &&in = std::filesystem::path((*v)[0]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+
+    if (!std::filesystem::is_directory(in)) {
+      paths.push_back(in.string());
+      names.push_back(in.filename().string());
+    } else {
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(in)) {
+        paths.push_back(one->getAbstractPath());
+        names.push_back(one->getName());
+      }
+    }
+
+    auto &&probes = std::vector<ImageProbe>(threads);
+    auto &&summaries = std::vector<Summary>(threads);
+    auto &&prog = Program(paths.size());
+    Parallel::forEach(threads, paths.size(), [&](Jsize i, Jint worker) {
+      verify(i, paths[i], names[i], probes[worker], summaries[worker]);
+      prog.updateOne();
+    });
+
+    for (auto &&summary : summaries) {
+      all.mUnreadable += summary.mUnreadable;
+      all.mSize += summary.mSize;
+      all.mBndbox += summary.mBndbox;
+      for (auto &&result : summary.mResults)
+        all.mResults.push_back(result);
+    }
+
+    std::stable_sort(all.mResults.begin(), all.mResults.end(),
+                     [](const Result &a, const Result &b) { return a.mIndex < b.mIndex; });
+    for (auto &&result : all.mResults)
+      Log::error(result.mMessage);
+
+    Log::info(FORMAT_DONE, static_cast<Jint>(paths.size()), all.mUnreadable, all.mSize,
+              all.mBndbox);
+    return 0;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_IMAGE_HPP
@@ -29,52 +29,160 @@ public:
         mName(move(name)), mLabel(move(label)), mSymbolMark(move(symbolMark)),
         mSymbolPath(move(symbolPath)), mFormatBuffer() {}
 
+  static void getPoints(Jint width, Jint height, Jint xmin, Jint ymin, Jint xmax, Jint ymax,
+                        Jfloat (&v)[8]) {
+    v[0] = static_cast<Jfloat>(xmin) / static_cast<Jfloat>(width);
+    v[1] = static_cast<Jfloat>(ymin) / static_cast<Jfloat>(height);
+    v[2] = static_cast<Jfloat>(xmax) / static_cast<Jfloat>(width);
+    v[3] = v[1];
+    v[4] = v[2];
+    v[5] = static_cast<Jfloat>(ymax) / static_cast<Jfloat>(height);
+    v[6] = v[0];
+    v[7] = v[5];
+  }
+
   std::string getRow() {
-    Jfloat x1 = 0;
-    Jfloat y1 = 0;
-    Jfloat x2 = 0;
-    Jfloat y2 = 0;
-    Jfloat x3 = 0;
-    Jfloat y3 = 0;
-    Jfloat x4 = 0;
-    Jfloat y4 = 0;
-
-    x1 = static_cast<Jfloat>(this->mXmin) / static_cast<Jfloat>(this->mWidth);
-    y1 = static_cast<Jfloat>(this->mYmin) / static_cast<Jfloat>(this->mHeight);
-    x2 = static_cast<Jfloat>(this->mXmax) / static_cast<Jfloat>(this->mWidth);
-    y2 = y1;
-    x3 = x2;
-    y3 = static_cast<Jfloat>(this->mYmax) / static_cast<Jfloat>(this->mHeight);
-    x4 = x1;
-    y4 = y3;
+    Jfloat v[8] = {};
+
+    getPoints(this->mWidth, this->mHeight, this->mXmin, this->mYmin, this->mXmax, this->mYmax, v);
 
     auto &&len = snprintf(this->mFormatBuffer, sizeof(this->mFormatBuffer), FORMAT_ROW,
                           this->mSymbolMark.c_str(), this->mSymbolPath.c_str(), this->mName.c_str(),
-                          this->mLabel.c_str(), x1, y1, x2, y2, x3, y3, x4, y4);
+                          this->mLabel.c_str(), v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
     this->mFormatBuffer[len] = 0x00;
     return this->mFormatBuffer;
   }
 };
 
+// a.csv.gz is written gzip compressed.
 class GoogleCloudCSV {
 private:
   constexpr static Jchar FILE_OPERATION_MODEL[] = "wb";
 
-  FILE *mCSVFile;
+  OutputFile mCSVFile;
 
 public:
-  explicit GoogleCloudCSV(Jint all, const Jchar *outfile) : mCSVFile() {
-    this->mCSVFile = fopen(outfile, FILE_OPERATION_MODEL);
+  explicit GoogleCloudCSV(Jint all, const Jchar *outfile)
+      : mCSVFile(outfile, Gzip::isGzip(outfile), FILE_OPERATION_MODEL,
+                 Parallel::getConcurrency()) {}
+
+  void add(GoogleCloudCSVFormat &v) { this->mCSVFile.write(v.getRow()); }
+
+  void add(const std::string &rows) { this->mCSVFile.write(rows); }
+
+  [[nodiscard]] Jbool isOpen() const { return this->mCSVFile.isOpen(); }
+
+  // False if any row failed to reach the file.
+  Jbool close() { return this->mCSVFile.close(); }
+};
+
+// Splits one CSV export over count files named a-00000-of-00016.csv. Every row goes to the
+// shard picked by a stable hash of its image path, so all rows of an image share a shard.
+// Rows are buffered per shard and each flush writes every shard at once from its own
+// thread; a.manifest lists the shard files when the export is closed.
+class ShardedCSV {
+private:
+  constexpr static Jsize SIZE_FLUSH = 8 * 1024 * 1024;
+  constexpr static Jint SIZE_SHARDS = 99999;
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar FORMAT_SHARD[] = "%s-%05d-of-%05d%s";
+  constexpr static Jchar SURRFIX_MANIFEST[] = ".manifest";
+
+  Jint mThreads;
+  Jsize mBuffered;
+  Jbool mFailed;
+  std::filesystem::path mOut;
+  std::vector<UP<OutputFile>> mFiles;
+  std::vector<std::string> mNames;
+  std::vector<std::string> mBuffers;
+
+public:
+  ShardedCSV(const std::filesystem::path &out, Jint count, Jint threads)
+      : mThreads(threads), mBuffered(), mFailed(), mOut(out), mFiles(), mNames(), mBuffers() {
+    auto &&compressed = Gzip::isGzip(out.string());
+    auto &&stem = compressed ? out.stem() : out;
+    auto &&prefix = (out.parent_path() / stem.stem()).string();
+    auto &&extension = stem.extension().string() + (compressed ? out.extension().string() : "");
+
+    count = std::max(count, 1);
+    this->mBuffers.resize(count);
+    for (Jint i = 0; i < count; ++i) {
+      this->mNames.push_back(
+          String::format(FORMAT_SHARD, prefix.c_str(), i, count, extension.c_str()));
+      this->mFiles.emplace_back(new OutputFile(this->mNames.back(), compressed));
+      this->mFailed = this->mFailed || !this->mFiles.back()->isOpen();
+    }
+  }
+
+  // Parses a --shards value; 0 when it is not a number from 1 to 99999.
+  static Jint getCount(const Jchar *v) {
+    Jchar *end = nullptr;
+    auto &&ret = std::strtol(v, &end, 10);
+    if ((end == v) || (*end != 0x00) || (ret < 1) || (ret > SIZE_SHARDS))
+      return 0;
+    return static_cast<Jint>(ret);
   }
 
-  ~GoogleCloudCSV() {
-    if (this->mCSVFile != nullptr)
-      fclose(this->mCSVFile);
+  ShardedCSV(const ShardedCSV &) = delete;
+
+  ShardedCSV &operator=(const ShardedCSV &) = delete;
+
+  ~ShardedCSV() { this->close(); }
+
+  [[nodiscard]] Jbool isOpen() const { return !this->mFailed; }
+
+  static Jsize getShard(std::string_view path, Jsize count) {
+    return Hash64::value(path.data(), path.size()) % count;
   }
 
-  void add(GoogleCloudCSVFormat &v) {
-    if (this->mCSVFile != nullptr)
-      fwrite(v.getRow().data(), v.getRow().size(), 1, this->mCSVFile);
+  // Takes complete rows; the second column of each is the image path.
+  void add(std::string_view rows) {
+    while (!rows.empty()) {
+      auto &&end = std::min(rows.find('\n'), rows.size() - 1) + 1;
+      auto &&line = rows.substr(0, end);
+      auto &&begin = std::min(line.find(','), line.size() - 1) + 1;
+      auto &&path = line.substr(begin, line.find(',', begin) - begin);
+
+      this->mBuffers[getShard(path, this->mBuffers.size())].append(line);
+      this->mBuffered += line.size();
+      rows.remove_prefix(end);
+    }
+    if (this->mBuffered >= SIZE_FLUSH)
+      this->flush();
+  }
+
+  void flush() {
+    Parallel::forEach(this->mThreads, this->mBuffers.size(), [this](Jsize shard, Jint) {
+      auto &&one = this->mBuffers[shard];
+      this->mFiles[shard]->write(one);
+      one.clear();
+    });
+    this->mBuffered = 0;
+  }
+
+  // Flushes and closes every shard, then writes the manifest; false if anything failed.
+  Jbool close() {
+    if (this->mFiles.empty())
+      return !this->mFailed;
+
+    this->flush();
+    for (auto &&file : this->mFiles)
+      this->mFailed = !file->close() || this->mFailed;
+    this->mFiles.clear();
+
+    auto &&manifest = this->mOut;
+    manifest.replace_extension(SURRFIX_MANIFEST);
+    auto &&output = fopen(manifest.c_str(), MODEL_WRITER_ONLY);
+    if (output == nullptr) {
+      this->mFailed = true;
+      return false;
+    }
+
+    for (auto &&name : this->mNames)
+      fprintf(output, "%s\n", std::filesystem::path(name).filename().c_str());
+    this->mFailed = (fflush(output) != 0) || this->mFailed;
+    this->mFailed = (fclose(output) != 0) || this->mFailed;
+    return !this->mFailed;
   }
 };
 
@@ -96,6 +204,12 @@ public:
   [[nodiscard]] Jint getHeight() const { return this->mHeight; }
 
   [[nodiscard]] Jint getDepth() const { return this->mDepth; }
+
+  void setWidth(Jint v) { this->mWidth = v; }
+
+  void setHeight(Jint v) { this->mHeight = v; }
+
+  void setDepth(Jint v) { this->mDepth = v; }
 };
 
 class LabelImageXMLSource {
@@ -108,6 +222,8 @@ public:
   LabelImageXMLSource() : mDatabase() {}
 
   [[nodiscard]] const std::string &getDatabase() const { return this->mDatabase; }
+
+  void setDatabase(const std::string &v) { this->mDatabase = v; }
 };
 
 class LabelImageXMLBndbox {
@@ -166,6 +282,12 @@ public:
 
   void setName(const std::string &v) { this->mName = v; }
 
+  void setPose(const std::string &v) { this->mPose = v; }
+
+  void setTruncated(Jint v) { this->mTruncated = v; }
+
+  void setDifficult(Jint v) { this->mDifficult = v; }
+
   void setBndbox(const LabelImageXMLBndbox &v) { this->mBndbox = v; }
 };
 
@@ -200,13 +322,6 @@ public:
 
 class LabelImageXML {
 private:
-  constexpr static Jint SIZE_BUFFER = 256;
-  constexpr static Jchar MODEL_READ[] = "rb";
-
-  FILE *mXml;
-  Jchar mBuffer[SIZE_BUFFER];
-  std::string mXmlContent;
-
   std::string mFolder;
   std::string mFilename;
   std::string mPath;
@@ -215,31 +330,18 @@ private:
   LabelImageXMLSize mSize;
 
   Jint mSegmented;
-  std::list<LabelImageXMLObject> mObjects;
+  std::vector<LabelImageXMLObject> mObjects;
+  Jbool mParsed;
 
-public:
-  explicit LabelImageXML(const std::string &v)
-      : mXml(), mBuffer(), mXmlContent(), mFolder(), mFilename(), mPath(), mSource(), mSize(),
-        mSegmented(), mObjects() {
+  void parse(const Jchar *data, Jsize length) {
     Jint i = 0;
-    Jint retLen = 0;
 
     QDomDocument document;
 
-    if (v.empty())
-      return;
-
-    this->mXml = fopen(v.c_str(), MODEL_READ);
-    if (this->mXml == nullptr)
+    this->mParsed = document.setContent(QString::fromUtf8(data, static_cast<Jint>(length)));
+    if (!this->mParsed)
       return;
 
-    do {
-      retLen = fread(this->mBuffer, 1, sizeof(this->mBuffer), this->mXml);
-      if (retLen > 0)
-        this->mXmlContent.append(this->mBuffer, retLen);
-    } while (retLen == sizeof(this->mBuffer));
-
-    document.setContent(QString(this->mXmlContent.data()));
     auto &&root = document.documentElement();
 
     this->mFolder = root.firstChildElement(LabelImageXMLTarget::FOLDER).text().toStdString();
@@ -274,13 +376,35 @@ public:
 
       this->mObjects.push_back(temp);
     }
+  }
+
+public:
+  // An empty document, filled in through the setters.
+  LabelImageXML()
+      : mFolder(), mFilename(), mPath(), mSource(), mSize(), mSegmented(), mObjects(),
+        mParsed() {}
+
+  // The file is only open while it is read.
+  explicit LabelImageXML(const std::string &v)
+      : mFolder(), mFilename(), mPath(), mSource(), mSize(), mSegmented(), mObjects(),
+        mParsed() {
+    std::string content;
+
+    if (v.empty() || !File::read(v, content))
+      return;
+    this->parse(content.data(), content.size());
   };
 
-  ~LabelImageXML() {
-    if (this->mXml != nullptr)
-      fclose(this->mXml);
+  // Parses a document already loaded by the caller, e.g. through BatchReader.
+  LabelImageXML(const Jchar *data, Jsize size)
+      : mFolder(), mFilename(), mPath(), mSource(), mSize(), mSegmented(), mObjects(),
+        mParsed() {
+    this->parse(data, size);
   }
 
+  // False when the file could not be read or is not well-formed XML.
+  [[nodiscard]] Jbool isParsed() const { return this->mParsed; }
+
   [[nodiscard]] const std::string &getFolder() const { return this->mFolder; }
 
   [[nodiscard]] const std::string &getFilename() const { return this->mFilename; }
@@ -293,15 +417,375 @@ public:
 
   [[nodiscard]] Jint getSegmented() const { return this->mSegmented; }
 
-  std::list<LabelImageXMLObject> &getObjects() { return this->mObjects; }
+  std::vector<LabelImageXMLObject> &getObjects() { return this->mObjects; }
+
+  void setFolder(const std::string &v) { this->mFolder = v; }
 
   void setFilename(const std::string &v) { this->mFilename = v; }
 
   void setPath(const std::string &v) { this->mPath = v; }
 
+  void setSource(const LabelImageXMLSource &v) { this->mSource = v; }
+
+  void setSize(const LabelImageXMLSize &v) { this->mSize = v; }
+
+  void setSegmented(Jint v) { this->mSegmented = v; }
+
   void addObject(const LabelImageXMLObject &v) { this->mObjects.push_back(v); }
 };
 
+class LabelImageArena;
+
+class LabelImageArenaObject {
+private:
+  std::string_view mName;
+  std::string_view mPose;
+
+  Jint mTruncated;
+  Jint mDifficult;
+
+  LabelImageXMLBndbox mBndbox;
+
+public:
+  friend LabelImageArena;
+
+  LabelImageArenaObject() : mName(), mPose(), mTruncated(), mDifficult(), mBndbox() {}
+
+  [[nodiscard]] std::string_view getName() const { return this->mName; }
+
+  [[nodiscard]] std::string_view getPose() const { return this->mPose; }
+
+  [[nodiscard]] Jint getTruncated() const { return this->mTruncated; }
+
+  [[nodiscard]] Jint getDifficult() const { return this->mDifficult; }
+
+  [[nodiscard]] const LabelImageXMLBndbox &getBndbox() const { return this->mBndbox; }
+};
+
+// Read-only annotation parsed in place: every string is a view into the document it owns and
+// objects sit in one vector. Both keep their storage from one document to the next, so a
+// worker that reuses one arena per file parses without touching the heap once warmed up.
+class LabelImageArena {
+private:
+  constexpr static Jint NONE = -1;
+
+  constexpr static Jchar MARK_COMMENT[] = "<!--";
+  constexpr static Jchar MARK_COMMENT_END[] = "-->";
+  constexpr static Jchar MARK_CDATA[] = "<![CDATA[";
+  constexpr static Jchar MARK_CDATA_END[] = "]]>";
+  constexpr static Jchar MARK_PI[] = "<?";
+  constexpr static Jchar MARK_PI_END[] = "?>";
+
+  struct Node {
+    std::string_view mName;
+    std::string_view mText;
+    Jint mParent;
+    Jbool mLeaf;
+  };
+
+  std::string mBuffer;
+  std::vector<Node> mNodes;
+  std::vector<Jint> mStack;
+  std::vector<Jsize> mContents;
+
+  std::string_view mFolder;
+  std::string_view mFilename;
+  std::string_view mPath;
+  std::string_view mDatabase;
+
+  LabelImageXMLSize mSize;
+
+  Jint mSegmented;
+  std::vector<LabelImageArenaObject> mObjects;
+
+  static Jbool isSpace(Jchar v) { return (v == ' ') || (v == '\t') || (v == '\r') || (v == '\n'); }
+
+  // Same contract as QString::toInt: surrounding blanks are allowed, anything else gives 0.
+  static Jint toInt(std::string_view v) {
+    Jint ret = 0;
+
+    while (!v.empty() && isSpace(v.front()))
+      v.remove_prefix(1);
+    while (!v.empty() && isSpace(v.back()))
+      v.remove_suffix(1);
+    if (!v.empty() && (v.front() == '+'))
+      v.remove_prefix(1);
+
+    auto &&end = v.data() + v.size();
+    auto &&result = std::from_chars(v.data(), end, ret);
+    return ((result.ec == std::errc()) && (result.ptr == end)) ? ret : 0;
+  }
+
+  static Jsize encode(Juint code, Jchar *out) {
+    if (code < 0x80) {
+      out[0] = static_cast<Jchar>(code);
+      return 1;
+    } else if (code < 0x800) {
+      out[0] = static_cast<Jchar>(0xc0 | (code >> 6));
+      out[1] = static_cast<Jchar>(0x80 | (code & 0x3f));
+      return 2;
+    } else if (code < 0x10000) {
+      out[0] = static_cast<Jchar>(0xe0 | (code >> 12));
+      out[1] = static_cast<Jchar>(0x80 | ((code >> 6) & 0x3f));
+      out[2] = static_cast<Jchar>(0x80 | (code & 0x3f));
+      return 3;
+    }
+    out[0] = static_cast<Jchar>(0xf0 | (code >> 18));
+    out[1] = static_cast<Jchar>(0x80 | ((code >> 12) & 0x3f));
+    out[2] = static_cast<Jchar>(0x80 | ((code >> 6) & 0x3f));
+    out[3] = static_cast<Jchar>(0x80 | (code & 0x3f));
+    return 4;
+  }
+
+  // Decodes the reference at data[i] ('&') into out and returns its length, or 0 if unknown.
+  // No reference is shorter than what it decodes to, so text can be rewritten in place.
+  static Jsize entity(std::string_view data, Jsize i, Jchar *out, Jsize &written) {
+    constexpr static std::pair<std::string_view, Jchar> NAMED[] = {
+        {"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+    for (auto &&one : NAMED) {
+      if (data.compare(i, one.first.size(), one.first) == 0) {
+        out[0] = one.second;
+        written = 1;
+        return one.first.size();
+      }
+    }
+
+    Juint code = 0;
+    auto &&end = data.find(';', i);
+    if ((end == std::string_view::npos) || (data.compare(i, 2, "&#") != 0))
+      return 0;
+
+    auto &&hex = (i + 2 < end) && (data[i + 2] == 'x');
+    auto &&begin = data.data() + i + (hex ? 3 : 2);
+    auto &&result = std::from_chars(begin, data.data() + end, code, hex ? 16 : 10);
+    if ((result.ec != std::errc()) || (result.ptr != data.data() + end) || (code > 0x10ffff))
+      return 0;
+
+    written = encode(code, out);
+    return end - i + 1;
+  }
+
+  // Rewrites [begin, end) in place to the text QDom would report: references decoded, CDATA
+  // kept, comments and processing instructions dropped.
+  std::string_view text(Jsize begin, Jsize end) {
+    Jsize i = begin;
+    Jsize out = begin;
+    auto &&data = std::string_view(this->mBuffer.data(), end);
+
+    while (i < end) {
+      Jsize written = 0;
+      Jsize length = 0;
+
+      if ((data[i] == '&') && ((length = entity(data, i, &this->mBuffer[out], written)) > 0)) {
+        i += length;
+        out += written;
+      } else if (data.compare(i, strlen(MARK_CDATA), MARK_CDATA) == 0) {
+        auto &&close = data.find(MARK_CDATA_END, i);
+        for (i += strlen(MARK_CDATA); i < close; ++i)
+          this->mBuffer[out++] = data[i];
+        i = close + strlen(MARK_CDATA_END);
+      } else if (data.compare(i, strlen(MARK_COMMENT), MARK_COMMENT) == 0) {
+        i = data.find(MARK_COMMENT_END, i) + strlen(MARK_COMMENT_END);
+      } else if (data.compare(i, strlen(MARK_PI), MARK_PI) == 0) {
+        i = data.find(MARK_PI_END, i) + strlen(MARK_PI_END);
+      } else {
+        this->mBuffer[out++] = data[i++];
+      }
+    }
+    return std::string_view(&this->mBuffer[begin], out - begin);
+  }
+
+  // Builds the element table; leaf text is decoded in place, elements with children get none.
+  Jbool scan() {
+    Jsize i = 0;
+    auto &&data = std::string_view(this->mBuffer);
+
+    while ((i = data.find('<', i)) != std::string_view::npos) {
+      auto &&skip = [&](const Jchar *close) {
+        auto &&end = data.find(close, i);
+        i = (end == std::string_view::npos) ? end : end + strlen(close);
+        return (end != std::string_view::npos);
+      };
+
+      if (data.compare(i, strlen(MARK_COMMENT), MARK_COMMENT) == 0) {
+        if (!skip(MARK_COMMENT_END))
+          return false;
+      } else if (data.compare(i, strlen(MARK_CDATA), MARK_CDATA) == 0) {
+        if (!skip(MARK_CDATA_END))
+          return false;
+      } else if (data.compare(i, strlen(MARK_PI), MARK_PI) == 0) {
+        if (!skip(MARK_PI_END))
+          return false;
+      } else if (data.compare(i, 2, "<!") == 0) {
+        // DOCTYPE, internal subset included.
+        auto &&subset = data.find('[', i);
+        auto &&close = data.find('>', i);
+        if ((subset != std::string_view::npos) && (subset < close))
+          close = data.find('>', data.find(']', subset));
+        if (close == std::string_view::npos)
+          return false;
+        i = close + 1;
+      } else if (data.compare(i, 2, "</") == 0) {
+        auto &&close = data.find('>', i);
+        if ((close == std::string_view::npos) || this->mStack.empty())
+          return false;
+
+        auto &&node = this->mNodes[this->mStack.back()];
+        if (node.mLeaf)
+          node.mText = this->text(this->mContents.back(), i);
+        this->mStack.pop_back();
+        this->mContents.pop_back();
+        i = close + 1;
+      } else {
+        Jchar quote = 0;
+        auto &&begin = i + 1;
+        auto end = begin;
+        while ((end < data.size()) && !isSpace(data[end]) && (data[end] != '/') &&
+               (data[end] != '>'))
+          ++end;
+
+        // Attributes are skipped; a quoted '>' does not close the tag.
+        for (i = end; (i < data.size()) && ((quote != 0) || (data[i] != '>')); ++i) {
+          if ((data[i] == '"') || (data[i] == '\''))
+            quote = (quote == 0) ? data[i] : ((quote == data[i]) ? 0 : quote);
+        }
+        if ((i >= data.size()) || (end == begin))
+          return false;
+
+        auto &&parent = this->mStack.empty() ? NONE : this->mStack.back();
+        if (parent != NONE)
+          this->mNodes[parent].mLeaf = false;
+        this->mNodes.push_back(Node{data.substr(begin, end - begin), {}, parent, true});
+        if (data[i - 1] != '/') {
+          this->mStack.push_back(static_cast<Jint>(this->mNodes.size() - 1));
+          this->mContents.push_back(i + 1);
+        }
+        ++i;
+      }
+    }
+    return this->mStack.empty() && !this->mNodes.empty();
+  }
+
+  // Same as QDomElement::firstChildElement. Nodes are in document order, so the subtree of
+  // parent ends at the first later node whose own parent comes before it.
+  [[nodiscard]] Jint child(Jint parent, std::string_view name) const {
+    for (auto i = parent + 1; i < static_cast<Jint>(this->mNodes.size()); ++i) {
+      if (this->mNodes[i].mParent < parent)
+        break;
+      if ((this->mNodes[i].mParent == parent) && (this->mNodes[i].mName == name))
+        return i;
+    }
+    return NONE;
+  }
+
+  [[nodiscard]] std::string_view text(Jint parent, std::string_view name) const {
+    auto &&i = (parent == NONE) ? NONE : this->child(parent, name);
+    return (i == NONE) ? std::string_view() : this->mNodes[i].mText;
+  }
+
+  Jbool parse() {
+    this->mNodes.clear();
+    this->mStack.clear();
+    this->mContents.clear();
+    this->mObjects.clear();
+    this->mFolder = this->mFilename = this->mPath = this->mDatabase = std::string_view();
+    this->mSize = LabelImageXMLSize();
+    this->mSegmented = 0;
+    if (!this->scan() || (this->mNodes[0].mName != LabelImageXMLTarget::ROOT))
+      return false;
+
+    this->mFolder = this->text(0, LabelImageXMLTarget::FOLDER);
+    this->mFilename = this->text(0, LabelImageXMLTarget::FILENAME);
+    this->mPath = this->text(0, LabelImageXMLTarget::PATH);
+    this->mSegmented = toInt(this->text(0, LabelImageXMLTarget::SEGMENTED));
+
+    auto &&source = this->child(0, LabelImageXMLTarget::SOURCE);
+    this->mDatabase = this->text(source, LabelImageXMLTarget::S_DATABASE);
+
+    auto &&size = this->child(0, LabelImageXMLTarget::SIZE);
+    this->mSize.setWidth(toInt(this->text(size, LabelImageXMLTarget::S_WIDTH)));
+    this->mSize.setHeight(toInt(this->text(size, LabelImageXMLTarget::S_HEIGHT)));
+    this->mSize.setDepth(toInt(this->text(size, LabelImageXMLTarget::S_DEPTH)));
+
+    // Only objects directly under the root; one nested elsewhere is not an annotation.
+    for (Jint i = 1; i < static_cast<Jint>(this->mNodes.size()); ++i) {
+      if ((this->mNodes[i].mParent != 0) || (this->mNodes[i].mName != LabelImageXMLTarget::OBJECT))
+        continue;
+
+      auto &&object = this->mObjects.emplace_back();
+      auto &&bndbox = this->child(i, LabelImageXMLTarget::O_BNDBOX);
+      object.mName = this->text(i, LabelImageXMLTarget::O_NAME);
+      object.mPose = this->text(i, LabelImageXMLTarget::O_POSE);
+      object.mTruncated = toInt(this->text(i, LabelImageXMLTarget::O_TRUNCATED));
+      object.mDifficult = toInt(this->text(i, LabelImageXMLTarget::O_DIFFICULT));
+
+      object.mBndbox.setMinX(toInt(this->text(bndbox, LabelImageXMLTarget::O_B_XMIN)));
+      object.mBndbox.setMinY(toInt(this->text(bndbox, LabelImageXMLTarget::O_B_YMIN)));
+      object.mBndbox.setMaxX(toInt(this->text(bndbox, LabelImageXMLTarget::O_B_XMAX)));
+      object.mBndbox.setMaxY(toInt(this->text(bndbox, LabelImageXMLTarget::O_B_YMAX)));
+    }
+    return true;
+  }
+
+public:
+  LabelImageArena()
+      : mBuffer(), mNodes(), mStack(), mContents(), mFolder(), mFilename(), mPath(),
+        mDatabase(), mSize(), mSegmented(), mObjects() {}
+
+  LabelImageArena(const LabelImageArena &) = delete;
+
+  LabelImageArena &operator=(const LabelImageArena &) = delete;
+
+  LabelImageArena(LabelImageArena &&) = default;
+
+  // Reads path into the arena's own buffer; previous views are invalidated.
+  Jbool load(const std::string &path) {
+    if (!File::read(path, this->mBuffer)) {
+      this->mBuffer.clear();
+      this->parse();
+      return false;
+    }
+    return this->parse();
+  }
+
+  // Takes over data, e.g. a BatchReader buffer, and hands back the previous document's
+  // storage in exchange so both sides keep their capacity.
+  Jbool parse(std::string &data) {
+    this->mBuffer.swap(data);
+    return this->parse();
+  }
+
+  [[nodiscard]] std::string_view getFolder() const { return this->mFolder; }
+
+  [[nodiscard]] std::string_view getFilename() const { return this->mFilename; }
+
+  [[nodiscard]] std::string_view getPath() const { return this->mPath; }
+
+  [[nodiscard]] std::string_view getDatabase() const { return this->mDatabase; }
+
+  [[nodiscard]] const LabelImageXMLSize &getSize() const { return this->mSize; }
+
+  [[nodiscard]] Jint getSegmented() const { return this->mSegmented; }
+
+  [[nodiscard]] const std::vector<LabelImageArenaObject> &getObjects() const {
+    return this->mObjects;
+  }
+};
+
+class LabelImageXMLImage {
+public:
+  static std::string getPath(const std::string &xmlPath, const LabelImageXML &xml) {
+    if (xml.getFilename().empty())
+      return xml.getPath();
+
+    auto &&local = std::filesystem::path(xmlPath).parent_path() / xml.getFilename();
+    if (File::isExist(local))
+      return local.string();
+    return xml.getPath();
+  }
+};
+
 enum LabelImageCoverCrop : Juint {
   CROP_BASE = 0x01,
   CROP_TOP_10 = CROP_BASE,
@@ -416,6 +900,15 @@ private:
 public:
   explicit LabelImageConver(SP<LabelImageXML> v) : mXml(move(v)) {}
 
+  // Applies Crop to the whole width x height frame instead of the first box.
+  template <Juint Crop>
+  static void window(Jint width, Jint height, Jint &minX, Jint &minY, Jint &maxX, Jint &maxY) {
+    minX = left<Crop>(0, width);
+    minY = top<Crop>(0, height);
+    maxX = right<Crop>(0, width);
+    maxY = bottom<Crop>(0, height);
+  }
+
   template <Juint Crop> void execute() {
     Jint minX = 0;
     Jint minY = 0;
@@ -473,7 +966,7 @@ private:
 
   constexpr static Jchar MODEL_WRITE[] = "wb";
 
-  FILE *mOutputFile;
+  SP<OutputFile> mOutputFile;
   SP<LabelImageXML> mInputXmls;
   std::string mOutputPath;
 
@@ -581,19 +1074,16 @@ public:
   explicit LabelImageXMLExporter(SP<LabelImageXML> input, std::string output)
       : mOutputFile(), mInputXmls(move(input)), mOutputPath(move(output)) {}
 
-  ~LabelImageXMLExporter() {
-    if (this->mOutputFile != nullptr)
-      fclose(this->mOutputFile);
-  }
-
+  // b.xml.gz is written gzip compressed.
   void exported() {
     QDomDocument document;
 
     if (this->mOutputPath.empty())
       return;
 
-    this->mOutputFile = fopen(this->mOutputPath.c_str(), MODEL_WRITE);
-    if (this->mOutputFile == nullptr)
+    this->mOutputFile =
+        make<OutputFile>(this->mOutputPath, Gzip::isGzip(this->mOutputPath), MODEL_WRITE);
+    if (!this->mOutputFile->isOpen())
       return;
 
     auto &&root = document.createElement(LabelImageXMLTarget::ROOT);
@@ -604,8 +1094,129 @@ public:
     document.appendChild(root);
 
     auto &&content = document.toString(SIZE_SPACE).toStdString();
-    fwrite(content.data(), content.size(), 1, this->mOutputFile);
-    fflush(this->mOutputFile);
+    this->mOutputFile->write(content);
+    this->mOutputFile->close();
+  }
+};
+
+class LabelImagePixels {
+private:
+  constexpr static Jfloat VISIBLE = 0.5f;
+  constexpr static Juint PIXEL_FILL = 0xff000000u;
+
+  constexpr static Jchar FORMAT_NAME[] = "%s-%02d%s";
+  constexpr static Jchar SURRFIX[] = ".xml";
+
+  SP<LabelImageXML> mXml;
+  QImage mImage;
+  std::filesystem::path mOut;
+  std::string mName;
+  std::string mExtension;
+  std::vector<std::string> mOutputs;
+  Jint mCount;
+
+  // Copies the window at (x, y) of source into target one row span at a time; the parts
+  // of the window outside source are filled with opaque black.
+  static void copy(const QImage &source, QImage &target, Jint x, Jint y) {
+    auto &&width = target.width();
+    auto begin = std::clamp(-x, 0, width);
+    auto end = std::clamp(source.width() - x, begin, width);
+
+    for (Jint row = 0; row < target.height(); ++row) {
+      auto &&out = reinterpret_cast<Juint *>(target.scanLine(row));
+      auto &&line = y + row;
+      if ((line < 0) || (line >= source.height())) {
+        std::fill_n(out, width, PIXEL_FILL);
+        continue;
+      }
+
+      auto &&in = reinterpret_cast<const Juint *>(source.constScanLine(line));
+      std::fill_n(out, begin, PIXEL_FILL);
+      memcpy(&out[begin], &in[x + begin], (end - begin) * sizeof(Juint));
+      std::fill_n(&out[end], width - end, PIXEL_FILL);
+    }
+  }
+
+  // Moves box into the window; boxes that keep less than VISIBLE of their area are dropped.
+  static Jbool rebase(LabelImageXMLObject &object, Jint x, Jint y, Jint width, Jint height) {
+    auto box = object.getBndbox();
+    auto &&area = static_cast<Jlong>(box.getMaxX() - box.getMinX()) *
+                  static_cast<Jlong>(box.getMaxY() - box.getMinY());
+    auto minX = std::clamp(box.getMinX() - x, 0, width);
+    auto minY = std::clamp(box.getMinY() - y, 0, height);
+    auto maxX = std::clamp(box.getMaxX() - x, 0, width);
+    auto maxY = std::clamp(box.getMaxY() - y, 0, height);
+    auto &&visible = static_cast<Jlong>(maxX - minX) * static_cast<Jlong>(maxY - minY);
+    if ((maxX <= minX) || (maxY <= minY) || (visible < area * VISIBLE))
+      return false;
+
+    box.setMinX(minX);
+    box.setMinY(minY);
+    box.setMaxX(maxX);
+    box.setMaxY(maxY);
+    object.setBndbox(box);
+    if (visible < area)
+      object.setTruncated(1);
+    return true;
+  }
+
+public:
+  LabelImagePixels(SP<LabelImageXML> xml, const std::string &image,
+                   const std::filesystem::path &out, std::string name)
+      : mXml(move(xml)), mImage(), mOut(out), mName(move(name)), mExtension(), mOutputs(),
+        mCount() {
+    this->mExtension = std::filesystem::path(image).extension().string();
+    this->mImage = QImage(QString::fromStdString(image)).convertToFormat(QImage::Format_ARGB32);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return !this->mImage.isNull(); }
+
+  [[nodiscard]] const std::vector<std::string> &getOutputs() const { return this->mOutputs; }
+
+  template <Juint Crop> void execute() {
+    Jint minX = 0;
+    Jint minY = 0;
+    Jint maxX = 0;
+    Jint maxY = 0;
+    LabelImageXMLSize size;
+
+    LabelImageConver::window<Crop>(this->mImage.width(), this->mImage.height(), minX, minY, maxX,
+                                   maxY);
+    auto &&width = maxX - minX;
+    auto &&height = maxY - minY;
+    if ((width <= 0) || (height <= 0))
+      return;
+
+    auto &&xml = make<LabelImageXML>();
+    for (auto &&one : this->mXml->getObjects()) {
+      auto object = one;
+      if (rebase(object, minX, minY, width, height))
+        xml->addObject(object);
+    }
+    if (xml->getObjects().empty())
+      return;
+
+    ++this->mCount;
+    auto &&filename = String::format(FORMAT_NAME, this->mName.c_str(), this->mCount,
+                                     this->mExtension.c_str());
+    auto &&xmlname = String::format(FORMAT_NAME, this->mName.c_str(), this->mCount, SURRFIX);
+    size.setWidth(width);
+    size.setHeight(height);
+    size.setDepth(this->mXml->getSize().getDepth());
+    xml->setFolder(this->mOut.filename().string());
+    xml->setFilename(filename);
+    xml->setPath((this->mOut / filename).string());
+    xml->setSource(this->mXml->getSource());
+    xml->setSize(size);
+    xml->setSegmented(this->mXml->getSegmented());
+
+    auto &&target = QImage(width, height, QImage::Format_ARGB32);
+    copy(this->mImage, target, minX, minY);
+    if (!target.save(QString::fromStdString((this->mOut / filename).string())))
+      return;
+    LabelImageXMLExporter(xml, (this->mOut / xmlname).string()).exported();
+    this->mOutputs.push_back((this->mOut / filename).string());
+    this->mOutputs.push_back((this->mOut / xmlname).string());
   }
 };
 
@@ -703,6 +1314,7 @@ public:
 class TFCSV {
 private:
   constexpr static Juint SIZE_READ_BUFFER = 1024;
+  constexpr static Jsize SIZE_STREAM = 64 * 1024 * 1024;
   constexpr static Jchar MODEL_READER_ONLY[] = "rb";
   constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
 
@@ -741,27 +1353,34 @@ private:
 public:
   explicit TFCSV(std::string v) : mPath(move(v)), mBuffer(), mRows() {}
 
+  static std::string getRow(const TFCSVRow &row) {
+    return String::format(EXPORTED_FORMAT, row.getModel().c_str(), row.getPath().c_str(),
+                          row.getTarget().c_str(), row.getX1(), row.getY1(), row.getX2(),
+                          row.getY2(), row.getX3(), row.getY3(), row.getX4(), row.getY4());
+  }
+
+  static void write(FILE *file, const TFCSVRow &row) {
+    auto &&v = getRow(row);
+    fwrite(v.data(), v.size(), 1, file);
+  }
+
   static Jint exported(const SP<TFCSV> &in, const std::string &out) {
     if (out.empty())
       return -1;
 
-    auto &&file = fopen(out.c_str(), MODEL_WRITER_ONLY);
-    if (file == nullptr)
+    auto &&file =
+        OutputFile(out, Gzip::isGzip(out), MODEL_WRITER_ONLY, Parallel::getConcurrency());
+    if (!file.isOpen())
       return -1;
 
-    for (auto &&row : in->getRows()) {
-      auto &&v = String::format(EXPORTED_FORMAT, row.getModel().c_str(), row.getPath().c_str(),
-                                row.getTarget().c_str(), row.getX1(), row.getY1(), row.getX2(),
-                                row.getY2(), row.getX3(), row.getY3(), row.getX4(), row.getY4());
-      fwrite(v.data(), v.size(), 1, file);
-    }
-
-    if (file != nullptr)
-      fclose(file);
-    return 0;
+    for (auto &&row : in->getRows())
+      file.write(getRow(row));
+    return file.close() ? 0 : -1;
   }
 
-  void parse() {
+  // zlib reads a plain file as it is and a .gz file decompressed. False when the file cannot
+  // be opened or a read fails, e.g. on a truncated .gz file.
+  Jbool parse() {
     Jint i = 0;
     Jint length = 0;
     Jint readLen = 0;
@@ -770,17 +1389,22 @@ public:
     TFCSVRow rowPoint;
 
     if (this->mPath.empty())
-      return;
+      return true;
 
-    auto &&file = fopen(this->mPath.c_str(), MODEL_READER_ONLY);
+    auto &&file = gzopen(this->mPath.c_str(), MODEL_READER_ONLY);
     if (file == nullptr)
-      return;
+      return false;
 
     do {
       if (length == 0)
         length = sizeof(this->mBuffer);
 
-      readLen += fread(&this->mBuffer[readLen], 1, length, file);
+      auto &&retLen = gzread(file, &this->mBuffer[readLen], length);
+      if ((retLen < 0) || ((retLen == 0) && !Gzip::isComplete(file))) {
+        gzclose(file);
+        return false;
+      }
+      readLen += retLen;
 
       if (readLen > 0) {
         targetMark = 0;
@@ -819,8 +1443,105 @@ public:
       }
     } while (readLen != 0);
 
-    if (file != nullptr)
-      fclose(file);
+    gzclose(file);
+    return true;
+  }
+
+  static Jbool parseLine(std::string_view v, TFCSVRow &row, std::string &buffer) {
+    Jsize i = 0;
+    Jint targetMark = 0;
+    Jint rowPointMark = 0;
+
+    while ((!v.empty()) && ((v.back() == '\r') || (v.back() == '\n')))
+      v.remove_suffix(1);
+    if (v.empty())
+      return false;
+
+    buffer.assign(v.data(), v.size());
+    buffer.push_back(0x00);
+    for (i = 0; i <= v.size(); ++i) {
+      if ((buffer[i] != ',') && (buffer[i] != 0x00))
+        continue;
+
+      buffer[i] = 0x00;
+      targetMark++;
+      target(row, &buffer[0], targetMark, rowPointMark);
+      rowPointMark = static_cast<Jint>(i) + 1;
+    }
+    return (targetMark >= 11);
+  }
+
+  static std::string_view field(std::string_view v, Jint n) {
+    Jsize begin = 0;
+
+    for (Jint i = 0; i < n; ++i) {
+      begin = v.find(',', begin);
+      if (begin == std::string_view::npos)
+        return std::string_view();
+      ++begin;
+    }
+
+    auto &&end = v.find(',', begin);
+    return v.substr(begin, (end == std::string_view::npos) ? end : end - begin);
+  }
+
+  // Plain files are mapped; .gz files are decompressed SIZE_STREAM bytes of lines at a time,
+  // so memory stays bounded whatever the file holds. False when a read fails.
+  template <class Fun> static Jbool forEachLine(const std::string &path, Jint threads, Fun &&fun) {
+    std::string chunk;
+    std::string_view line;
+
+    if (!Gzip::isGzip(path)) {
+      auto &&file = MappedFile(path);
+      if (!file.isOpen())
+        return false;
+
+      file.advise(MADV_SEQUENTIAL);
+      forEachLine(reinterpret_cast<const Jchar *>(file.getData()), file.getSize(), threads, fun);
+      return true;
+    }
+
+    auto &&in = LineReader(path);
+    if (!in.isOpen())
+      return false;
+
+    chunk.reserve(SIZE_STREAM);
+    while (in.next(line)) {
+      chunk.append(line).push_back('\n');
+      if (chunk.size() < SIZE_STREAM)
+        continue;
+      forEachLine(chunk.data(), chunk.size(), threads, fun);
+      chunk.clear();
+    }
+    forEachLine(chunk.data(), chunk.size(), threads, fun);
+    return !in.isFailed();
+  }
+
+  template <class Fun>
+  static void forEachLine(const Jchar *data, Jsize size, Jint threads, Fun &&fun) {
+    if (size == 0)
+      return;
+
+    auto &&chunks = static_cast<Jsize>(threads) * 4;
+    auto &&starts = std::vector<Jsize>(chunks + 1, size);
+
+    starts[0] = 0;
+    for (Jsize i = 1; i < chunks; ++i) {
+      auto guess = std::max(starts[i - 1], size / chunks * i);
+      auto &&lf = static_cast<const Jchar *>(memchr(&data[guess], '\n', size - guess));
+      starts[i] = (lf == nullptr) ? size : static_cast<Jsize>(lf - data) + 1;
+    }
+
+    Parallel::forEach(threads, chunks, [&](Jsize chunk, Jint worker) {
+      auto begin = starts[chunk];
+      auto end = starts[chunk + 1];
+      while (begin < end) {
+        auto &&lf = static_cast<const Jchar *>(memchr(&data[begin], '\n', end - begin));
+        auto &&stop = (lf == nullptr) ? end : static_cast<Jsize>(lf - data);
+        fun(std::string_view(&data[begin], stop - begin), worker);
+        begin = stop + 1;
+      }
+    });
   }
 
   void addRow(const TFCSVRow &v) { this->mRows.emplace_back(v); }
@@ -828,6 +1549,224 @@ public:
   std::list<TFCSVRow> &getRows() { return this->mRows; }
 };
 
+class DatasetHistogram {
+private:
+  std::vector<Jfloat> mEdges;
+  std::vector<Jlong> mCounts;
+
+public:
+  explicit DatasetHistogram(std::vector<Jfloat> edges)
+      : mEdges(move(edges)), mCounts(mEdges.size() + 1) {}
+
+  void add(Jfloat v) {
+    auto &&it = std::upper_bound(this->mEdges.begin(), this->mEdges.end(), v);
+    ++this->mCounts[it - this->mEdges.begin()];
+  }
+
+  void merge(const DatasetHistogram &v) {
+    for (Jsize i = 0; i < this->mCounts.size(); ++i)
+      this->mCounts[i] += v.mCounts[i];
+  }
+
+  [[nodiscard]] const std::vector<Jfloat> &getEdges() const { return this->mEdges; }
+
+  [[nodiscard]] const std::vector<Jlong> &getCounts() const { return this->mCounts; }
+};
+
+class DatasetLabel {
+public:
+  Jlong mObjects;
+  Jlong mImages;
+  std::set<uint64_t> mPaths;
+
+  DatasetLabel() : mObjects(), mImages(), mPaths() {}
+};
+
+class DatasetStatistics {
+private:
+  constexpr static Jchar FORMAT_TABLE_HEAD[] = "%-24s %12s %12s\n";
+  constexpr static Jchar FORMAT_TABLE_ROW[] = "%-24s %12lld %12lld\n";
+  constexpr static Jchar FORMAT_TABLE_NAME[] = "%-8s";
+  constexpr static Jchar FORMAT_TABLE_BIN[] = " <%g:%lld";
+  constexpr static Jchar FORMAT_TABLE_LAST[] = " >=%g:%lld\n";
+  constexpr static Jchar FORMAT_TABLE_SIZE[] = "size     %dx%d:%lld\n";
+
+  Jlong mImages;
+  Jlong mObjects;
+  std::map<std::string, DatasetLabel, std::less<>> mLabels;
+  std::map<std::pair<Jint, Jint>, Jlong> mSizes;
+
+  DatasetHistogram mWidth;
+  DatasetHistogram mHeight;
+  DatasetHistogram mAspect;
+  DatasetHistogram mArea;
+
+  static void printJson(const std::string &v) {
+    putchar('"');
+    for (auto &&c : v) {
+      if ((c == '"') || (c == '\\')) {
+        putchar('\\');
+        putchar(c);
+      } else if (static_cast<Jbyte>(c) < 0x20) {
+        printf("\\u%04x", static_cast<Jint>(c));
+      } else {
+        putchar(c);
+      }
+    }
+    putchar('"');
+  }
+
+  static void printJson(const Jchar *name, const DatasetHistogram &v) {
+    printf(",\"%s\":{\"edges\":[", name);
+    for (Jsize i = 0; i < v.getEdges().size(); ++i)
+      printf((i == 0) ? "%g" : ",%g", v.getEdges()[i]);
+    printf("],\"counts\":[");
+    for (Jsize i = 0; i < v.getCounts().size(); ++i)
+      printf((i == 0) ? "%lld" : ",%lld", v.getCounts()[i]);
+    printf("]}");
+  }
+
+  static void printTable(const Jchar *name, const DatasetHistogram &v) {
+    printf(FORMAT_TABLE_NAME, name);
+    for (Jsize i = 0; i < v.getEdges().size(); ++i)
+      printf(FORMAT_TABLE_BIN, v.getEdges()[i], v.getCounts()[i]);
+    printf(FORMAT_TABLE_LAST, v.getEdges().back(), v.getCounts().back());
+  }
+
+public:
+  DatasetStatistics()
+      : mImages(), mObjects(), mLabels(), mSizes(),
+        mWidth({0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f}),
+        mHeight({0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f}),
+        mAspect({0.25f, 0.5f, 1.0f, 2.0f, 4.0f}),
+        mArea({0.001f, 0.01f, 0.05f, 0.1f, 0.25f, 0.5f}) {}
+
+  void addImage(Jint width, Jint height) {
+    ++this->mImages;
+    if ((width > 0) && (height > 0))
+      ++this->mSizes[{width, height}];
+  }
+
+  void addObject(std::string_view label, uint64_t image, Jfloat x1, Jfloat y1, Jfloat x2,
+                 Jfloat y2, Jfloat aspect) {
+    auto &&width = x2 - x1;
+    auto &&height = y2 - y1;
+    auto it = this->mLabels.find(label);
+    if (it == this->mLabels.end())
+      it = this->mLabels.emplace(std::string(label), DatasetLabel()).first;
+    auto &&one = it->second;
+
+    ++this->mObjects;
+    ++one.mObjects;
+    one.mPaths.insert(image);
+
+    this->mWidth.add(width);
+    this->mHeight.add(height);
+    this->mArea.add(width * height);
+    if (height > 0)
+      this->mAspect.add(aspect);
+  }
+
+  // T is LabelImageXML or LabelImageArena.
+  template <class T> void addXml(const std::string &path, T &xml) {
+    auto &&width = xml.getSize().getWidth();
+    auto &&height = xml.getSize().getHeight();
+    auto &&image = Hash64::value(path.data(), path.size());
+
+    this->addImage(width, height);
+    if ((width <= 0) || (height <= 0))
+      return;
+
+    for (auto &&object : xml.getObjects()) {
+      auto &&box = object.getBndbox();
+      auto &&pixelHeight = static_cast<Jfloat>(box.getMaxY() - box.getMinY());
+      auto &&aspect = static_cast<Jfloat>(box.getMaxX() - box.getMinX()) / pixelHeight;
+      this->addObject(object.getName(), image, static_cast<Jfloat>(box.getMinX()) / width,
+                      static_cast<Jfloat>(box.getMinY()) / height,
+                      static_cast<Jfloat>(box.getMaxX()) / width,
+                      static_cast<Jfloat>(box.getMaxY()) / height, aspect);
+    }
+  }
+
+  void addRow(const TFCSVRow &row) {
+    auto &&image = Hash64::value(row.getPath().data(), row.getPath().size());
+    auto &&height = row.getY3() - row.getY1();
+    this->addObject(row.getTarget(), image, row.getX1(), row.getY1(), row.getX3(), row.getY3(),
+                    (row.getX3() - row.getX1()) / height);
+  }
+
+  void merge(DatasetStatistics &v) {
+    this->mImages += v.mImages;
+    this->mObjects += v.mObjects;
+    for (auto &&kv : v.mLabels) {
+      auto &&one = this->mLabels[kv.first];
+      one.mObjects += kv.second.mObjects;
+      one.mPaths.merge(kv.second.mPaths);
+    }
+    for (auto &&kv : v.mSizes)
+      this->mSizes[kv.first] += kv.second;
+
+    this->mWidth.merge(v.mWidth);
+    this->mHeight.merge(v.mHeight);
+    this->mAspect.merge(v.mAspect);
+    this->mArea.merge(v.mArea);
+  }
+
+  void finish() {
+    std::set<uint64_t> images;
+
+    for (auto &&kv : this->mLabels) {
+      kv.second.mImages = static_cast<Jlong>(kv.second.mPaths.size());
+      images.insert(kv.second.mPaths.begin(), kv.second.mPaths.end());
+      kv.second.mPaths.clear();
+    }
+    if (this->mImages == 0)
+      this->mImages = static_cast<Jlong>(images.size());
+  }
+
+  void printTable() {
+    printf(FORMAT_TABLE_HEAD, "label", "objects", "images");
+    for (auto &&kv : this->mLabels)
+      printf(FORMAT_TABLE_ROW, kv.first.c_str(), kv.second.mObjects, kv.second.mImages);
+    printf(FORMAT_TABLE_ROW, "*", this->mObjects, this->mImages);
+
+    printTable("width", this->mWidth);
+    printTable("height", this->mHeight);
+    printTable("aspect", this->mAspect);
+    printTable("area", this->mArea);
+    for (auto &&kv : this->mSizes)
+      printf(FORMAT_TABLE_SIZE, kv.first.first, kv.first.second, kv.second);
+  }
+
+  void printJson() {
+    Jbool first = true;
+
+    printf("{\"images\":%lld,\"objects\":%lld,\"labels\":{", this->mImages, this->mObjects);
+    for (auto &&kv : this->mLabels) {
+      if (!first)
+        putchar(',');
+      first = false;
+      printJson(kv.first);
+      printf(":{\"objects\":%lld,\"images\":%lld}", kv.second.mObjects, kv.second.mImages);
+    }
+    putchar('}');
+
+    printJson("width", this->mWidth);
+    printJson("height", this->mHeight);
+    printJson("aspect", this->mAspect);
+    printJson("area", this->mArea);
+
+    first = true;
+    printf(",\"sizes\":{");
+    for (auto &&kv : this->mSizes) {
+      printf(first ? "\"%dx%d\":%lld" : ",\"%dx%d\":%lld", kv.first.first, kv.first.second,
+             kv.second);
+      first = false;
+    }
+    printf("}}\n");
+  }
+};
+
 } // namespace tfutils
 
 #endif // TFUTILS_TF_COMMAND_TENSORFLOW_IMPL_HPP
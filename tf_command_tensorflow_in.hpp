@@ -5,26 +5,133 @@ namespace tfutils {
 
 class TensorflowCheck : public AbstractCommand {
 private:
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar MARK_STATS[] = "stats";
+  constexpr static Jchar MODEL_JSON[] = "json";
+
   constexpr static Jchar FORMAT_FILENAME[] = "file: %s-%s-%s";
   constexpr static Jchar FORMAT_PATH[] = "file: %s-%s-%s";
   constexpr static Jchar FORMAT_SIZE[] = "file: %s-%s-%dx%d";
   constexpr static Jchar FORMAT_NAME[] = "file: %s-%s-%s";
 
-  static void print(const SP<LabelImageXML> &xml, const std::string &mark,
+  static void print(const LabelImageArena &xml, const std::string &mark,
                     const std::string &name) {
     if (mark == LabelImageXMLTarget::FILENAME) {
-      Log::info(FORMAT_FILENAME, name.c_str(), mark.c_str(), xml->getFilename().c_str());
+      auto &&filename = std::string(xml.getFilename());
+      Log::info(FORMAT_FILENAME, name.c_str(), mark.c_str(), filename.c_str());
     } else if (mark == LabelImageXMLTarget::PATH) {
-      Log::info(FORMAT_PATH, name.c_str(), mark.c_str(), xml->getPath().c_str());
+      auto &&path = std::string(xml.getPath());
+      Log::info(FORMAT_PATH, name.c_str(), mark.c_str(), path.c_str());
     } else if (mark == LabelImageXMLTarget::SIZE) {
-      Log::info(FORMAT_SIZE, name.c_str(), mark.c_str(), xml->getSize().getWidth(),
-                xml->getSize().getHeight());
+      Log::info(FORMAT_SIZE, name.c_str(), mark.c_str(), xml.getSize().getWidth(),
+                xml.getSize().getHeight());
     } else if (mark == LabelImageXMLTarget::O_NAME) {
-      for (auto &&obj : xml->getObjects())
-        Log::info(FORMAT_NAME, name.c_str(), mark.c_str(), obj.getName().c_str());
+      for (auto &&obj : xml.getObjects()) {
+        auto &&label = std::string(obj.getName());
+        Log::info(FORMAT_NAME, name.c_str(), mark.c_str(), label.c_str());
+      }
+    }
+  }
+
+  static void print(const ColumnFile &file, const std::string &mark) {
+    auto &&offsets = file.getOffsets();
+    for (Jsize i = 0; i < file.getImages(); ++i) {
+      auto &&path = std::string(file.getPaths()[i]);
+      auto &&name = std::filesystem::path(path).filename().string();
+      if (mark == LabelImageXMLTarget::FILENAME) {
+        Log::info(FORMAT_FILENAME, name.c_str(), mark.c_str(), name.c_str());
+      } else if (mark == LabelImageXMLTarget::PATH) {
+        Log::info(FORMAT_PATH, name.c_str(), mark.c_str(), path.c_str());
+      } else if (mark == LabelImageXMLTarget::SIZE) {
+        Log::info(FORMAT_SIZE, name.c_str(), mark.c_str(), file.getWidth()[i],
+                  file.getHeight()[i]);
+      } else if (mark == LabelImageXMLTarget::O_NAME) {
+        for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+          auto &&label = std::string(file.getLabelNames()[file.getLabel()[j]]);
+          Log::info(FORMAT_NAME, name.c_str(), mark.c_str(), label.c_str());
+        }
+      }
     }
   }
 
+  static void stats(const ColumnFile &file, Jint threads,
+                    std::vector<DatasetStatistics> &partials) {
+    std::vector<std::string> labels;
+
+    for (Jsize i = 0; i < file.getLabelNames().size(); ++i)
+      labels.emplace_back(file.getLabelNames()[i]);
+
+    auto &&offsets = file.getOffsets();
+    auto &&label = file.getLabel();
+    auto &&x1 = file.getPoint(0);
+    auto &&y1 = file.getPoint(1);
+    auto &&x3 = file.getPoint(4);
+    auto &&y3 = file.getPoint(5);
+    Parallel::forEach(threads, file.getImages(), [&](Jsize i, Jint worker) {
+      auto &&one = partials[worker];
+      auto &&width = file.getWidth()[i];
+      auto &&height = file.getHeight()[i];
+
+      // Sized images (written from XML) keep the pixel aspect ratio addXml reports.
+      auto &&ratio = ((width > 0) && (height > 0)) ? static_cast<Jfloat>(width) / height : 1.0f;
+      one.addImage(width, height);
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+        if (label[j] >= labels.size())
+          continue;
+        one.addObject(labels[label[j]], i, x1[j], y1[j], x3[j], y3[j],
+                      (x3[j] - x1[j]) * ratio / (y3[j] - y1[j]));
+      }
+    });
+  }
+
+  static Jint stats(const std::filesystem::path &path, Jint threads, Jbool json) {
+    std::vector<std::string> paths;
+    UP<File> file(new File());
+
+    auto &&partials = std::vector<DatasetStatistics>(threads);
+    if (path.extension() == ColumnFile::SURRFIX) {
+      auto &&columns = ColumnFile(path);
+      if (!columns.isOpen())
+        return -1;
+      stats(columns, threads, partials);
+    } else if (Gzip::getExtension(path) == SURRFIX_CSV) {
+      auto &&rows = std::vector<TFCSVRow>(threads);
+      auto &&buffers = std::vector<std::string>(threads);
+      auto &&ret = TFCSV::forEachLine(path, threads, [&](std::string_view line, Jint worker) {
+        if (TFCSV::parseLine(line, rows[worker], buffers[worker]))
+          partials[worker].addRow(rows[worker]);
+      });
+      if (!ret)
+        return -1;
+    } else {
+      if (!std::filesystem::is_directory(path)) {
+        paths.push_back(path.string());
+      } else {
+        for (auto &&one : file->getFilesInDirectory<SURRFIX>(path))
+          paths.push_back(one->getAbstractPath());
+      }
+
+      auto &&arenas = std::vector<LabelImageArena>(threads);
+      BatchReader::forEach(paths, threads, [&](Jsize i, std::string &data, Jint worker) {
+        arenas[worker].parse(data);
+        partials[worker].addXml(paths[i], arenas[worker]);
+      });
+    }
+
+    for (Jsize i = 1; i < partials.size(); ++i)
+      partials[0].merge(partials[i]);
+    partials[0].finish();
+
+    if (json)
+      partials[0].printJson();
+    else
+      partials[0].printTable();
+    return 0;
+  }
+
 public:
   using AbstractCommand::AbstractCommand;
 
@@ -34,18 +141,37 @@ public:
 
     auto &&path = std::filesystem::path((*v)[0]);
     auto &&mark = std::string((*v)[1]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
 
-    if (!std::filesystem::is_directory(path)) {
-      auto &&xml = make<LabelImageXML>(path);
+    if (mark == MARK_STATS) {
+      auto &&json = (v->getLength() > 2) && (strcmp((*v)[2], MODEL_JSON) == 0);
+      return stats(path, threads, json);
+    }
+
+    if (path.extension() == ColumnFile::SURRFIX) {
+      auto &&columns = ColumnFile(path);
+      if (!columns.isOpen())
+        return -1;
+      print(columns, mark);
+    } else if (!std::filesystem::is_directory(path)) {
+      LabelImageArena xml;
+      xml.load(path);
       print(xml, mark, path.filename());
     } else {
-      auto &&file = make<File>();
-      auto &&list = file->getFilesInDirectory(path);
+      std::vector<std::string> paths;
+      std::vector<std::string> names;
 
-      for (auto &&one : list) {
-        auto &&xml = make<LabelImageXML>(one->getAbstractPath());
-        print(xml, mark, one->getName());
+      auto &&file = make<File>();
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(path)) {
+        paths.push_back(one->getAbstractPath());
+        names.push_back(one->getName());
       }
+
+      auto &&arenas = std::vector<LabelImageArena>(threads);
+      BatchReader::forEach(paths, threads, [&](Jsize i, std::string &data, Jint worker) {
+        arenas[worker].parse(data);
+        print(arenas[worker], mark, names[i]);
+      });
     }
     return 0;
   }
@@ -53,6 +179,10 @@ public:
 
 class TensorflowRotate : public AbstractCommand {
 private:
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
   constexpr static Jchar FORMAT_NAME[] = "file: %s-%s-%s, replace value: %s";
 
   static void replace(const SP<LabelImageXML> &xml, const std::string &mark,
@@ -63,6 +193,132 @@ private:
     }
   }
 
+  static std::string escape(const std::string &v) {
+    std::string ret;
+
+    for (auto &&c : v) {
+      if (c == '&')
+        ret.append("&amp;");
+      else if (c == '<')
+        ret.append("&lt;");
+      else if (c == '>')
+        ret.append("&gt;");
+      else
+        ret.push_back(c);
+    }
+    return ret;
+  }
+
+  // Copies data to out with the text of every <name> directly under an <object> replaced by
+  // escaped; all other bytes are kept as they are. Returns false on markup it cannot follow,
+  // leaving the file to the DOM path.
+  static Jbool splice(std::string_view data, const std::string &value, const std::string &escaped,
+                      const std::string &mark, const std::string &name, std::string &out,
+                      Jint &count) {
+    Jsize i = 0;
+    Jsize depth = 0;
+    Jsize copied = 0;
+    Jsize content = std::string_view::npos;
+    std::vector<std::string_view> stack;
+
+    out.clear();
+    out.reserve(data.size());
+    while ((i = data.find('<', i)) != std::string_view::npos) {
+      auto &&skip = [&](std::string_view open, std::string_view close) {
+        if (data.compare(i, open.size(), open) != 0)
+          return false;
+        auto &&end = data.find(close, i + open.size());
+        i = (end == std::string_view::npos) ? data.size() : end + close.size();
+        return true;
+      };
+
+      if (skip("<!--", "-->") || skip("<![CDATA[", "]]>") || skip("<?", "?>") ||
+          skip("<!", ">"))
+        continue;
+
+      auto &&close = data.find('>', i);
+      if (close == std::string_view::npos)
+        return false;
+
+      if (data[i + 1] == '/') {
+        if (stack.empty())
+          return false;
+        if ((content != std::string_view::npos) && (stack.size() == depth)) {
+          auto &&old = std::string(data.substr(content, i - content));
+          Log::info(FORMAT_NAME, name.c_str(), mark.c_str(), old.c_str(), value.c_str());
+          out.append(data.substr(copied, content - copied)).append(escaped);
+          copied = i;
+          content = std::string_view::npos;
+          ++count;
+        }
+        stack.pop_back();
+        i = close + 1;
+        continue;
+      }
+
+      auto &&begin = i + 1;
+      auto end = begin;
+      while ((end < close) && !isspace(static_cast<Jbyte>(data[end])) && (data[end] != '/'))
+        ++end;
+
+      auto &&tag = data.substr(begin, end - begin);
+      auto &&target = (tag == LabelImageXMLTarget::O_NAME) && !stack.empty() &&
+                      (stack.back() == LabelImageXMLTarget::OBJECT);
+      if (data[close - 1] == '/') {
+        // An empty <name/> is written out in full.
+        if (target) {
+          Log::info(FORMAT_NAME, name.c_str(), mark.c_str(), "", value.c_str());
+          out.append(data.substr(copied, i - copied)).append("<").append(tag).append(">");
+          out.append(escaped).append("</").append(tag).append(">");
+          copied = close + 1;
+          ++count;
+        }
+      } else {
+        stack.push_back(tag);
+        if (target) {
+          content = close + 1;
+          depth = stack.size();
+        }
+      }
+      i = close + 1;
+    }
+    if (!stack.empty())
+      return false;
+
+    out.append(data.substr(copied));
+    return true;
+  }
+
+  static Jbool write(const std::string &path, const std::string &data) {
+    auto &&temp = path + SURRFIX_TEMP;
+    auto &&output = OutputFile(temp, Gzip::isGzip(path), MODEL_WRITER_ONLY);
+    if (!output.isOpen())
+      return false;
+
+    output.write(data);
+    if (output.close() && (rename(temp.c_str(), path.c_str()) == 0))
+      return true;
+
+    File::remove(temp);
+    return false;
+  }
+
+  // Rewrites the names in place at the byte level; the DOM round trip is only the fallback.
+  static void rotate(const std::string &path, std::string &data, const std::string &mark,
+                     const std::string &name, const std::string &value, std::string &out) {
+    Jint count = 0;
+
+    if (splice(data, value, escape(value), mark, name, out, count)) {
+      if (count > 0)
+        write(path, out);
+      return;
+    }
+
+    auto &&xml = make<LabelImageXML>(data.data(), data.size());
+    replace(xml, mark, name, value);
+    LabelImageXMLExporter(xml, path).exported();
+  }
+
 public:
   using AbstractCommand::AbstractCommand;
 
@@ -75,17 +331,26 @@ public:
     auto &&value = std::string((*v)[2]);
 
     if (!std::filesystem::is_directory(path)) {
-      auto &&xml = make<LabelImageXML>(path);
-      replace(xml, mark, path.filename(), value);
+      std::string data;
+      std::string out;
+      if (!File::read(path, data))
+        return -1;
+      rotate(path, data, mark, path.filename(), value, out);
     } else {
-      auto &&file = make<File>();
-      auto &&list = file->getFilesInDirectory(path);
+      std::vector<std::string> paths;
+      std::vector<std::string> names;
 
-      for (auto &&one : list) {
-        auto &&xml = make<LabelImageXML>(one->getAbstractPath());
-        replace(xml, mark, one->getName(), value);
-        LabelImageXMLExporter(xml, one->getAbstractPath()).exported();
+      auto &&file = make<File>();
+      for (auto &&one : file->getFilesInDirectory<SURRFIX>(path)) {
+        paths.push_back(one->getAbstractPath());
+        names.push_back(one->getName());
       }
+
+      auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+      auto &&outs = std::vector<std::string>(threads);
+      BatchReader::forEach(paths, threads, [&](Jsize i, std::string &data, Jint worker) {
+        rotate(paths[i], data, mark, names[i], value, outs[worker]);
+      });
     }
     return 0;
   }
@@ -93,8 +358,11 @@ public:
 
 class TensorflowClone : public AbstractCommand {
 private:
+  constexpr static Jchar OPTION_RESUME[] = "resume";
+  constexpr static Jchar FORMAT_UNIT[] = "%s#%d";
   constexpr static Jchar FORMAT_FILE_NAME[] = "%d%s";
   constexpr static Jchar FORMAT_FILE_PATH[] = "%s/%s";
+  constexpr static Jchar FORMAT_JOURNAL[] = "file: %s, journal open failed, progress is not saved";
 
 public:
   using AbstractCommand::AbstractCommand;
@@ -116,8 +384,17 @@ public:
     auto &&prefix = std::filesystem::path(basexml->getFilename()).extension();
     auto &&basepath = std::filesystem::path(basexml->getPath()).parent_path();
 
+    Journal journal(".", this->getName(), v->hasOption(OPTION_RESUME));
+    if (!journal.isOpen())
+      Log::error(FORMAT_JOURNAL, journal.getPath().c_str());
     auto &&prog = Program(length - i);
     for (; i <= length; ++i) {
+      auto &&unit = String::format(FORMAT_UNIT, file, i);
+      if (journal.isDone(unit)) {
+        prog.updateOne();
+        continue;
+      }
+
       auto &&xmlNew = *basexml;
       auto &&filename = String::format(FORMAT_FILE_NAME, i, prefix.c_str());
       xmlNew.setFilename(filename);
@@ -126,6 +403,8 @@ public:
       auto &&newfilename = String::format(FORMAT_FILE_NAME, i, oldpre.c_str());
       LabelImageXMLExporter(SP<LabelImageXML>(&xmlNew, [](LabelImageXML *) {}), newfilename)
           .exported();
+      if (File::isExist(newfilename))
+        journal.add(unit, {newfilename});
 
       prog.updateOne();
     }
@@ -139,8 +418,14 @@ private:
   constexpr static Jint COMMAND_WIDTH = 224;
   constexpr static Jint COMMAND_HEIGHT = 224;
 
+  constexpr static Jchar OPTION_RESUME[] = "resume";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar COMMAND_CONVERT[] = "convert";
+  constexpr static Jchar COMMAND_RESIZE[] = "-resize";
   constexpr static Jchar FORMAT_LINUX_OUTPUT[] = "%s/%s";
-  constexpr static Jchar FORMAT_LINUX_CONVERT[] = "convert -resize %dx%d %s %s";
+  constexpr static Jchar FORMAT_LINUX_SIZE[] = "%dx%d";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, convert failed";
+  constexpr static Jchar FORMAT_JOURNAL[] = "file: %s, journal open failed, progress is not saved";
 
 public:
   using AbstractCommand::AbstractCommand;
@@ -166,28 +451,102 @@ public:
     if ((File::isFile(indir)) || (File::isFile(oudir)))
       return -1;
 
+    Journal journal(oudir, this->getName(), v->hasOption(OPTION_RESUME));
+    if (!journal.isOpen())
+      Log::error(FORMAT_JOURNAL, journal.getPath().c_str());
+    std::vector<std::string> paths;
+    std::vector<std::string> outputs;
+    auto &&size = String::format(FORMAT_LINUX_SIZE, width, height);
     auto &&dir = file->getFilesInDirectory(indir);
+    auto &&pool = ProcessPool(Parallel::getConcurrency(v->getOption(OPTION_THREADS)));
     Program prog(dir.size());
     for (auto &&p : dir) {
-      auto &&name = p->getName();
       auto &&path = p->getAbstractPath();
+      if (journal.isDone(path)) {
+        prog.updateOne();
+        continue;
+      }
 
-      auto &&output = String::format(FORMAT_LINUX_OUTPUT, oudir, name.c_str());
-      auto &&command =
-          String::format(FORMAT_LINUX_CONVERT, width, height, path.c_str(), output.c_str());
-
-      System(command).execute();
-      prog.updateOne();
+      paths.push_back(path);
+      outputs.push_back(String::format(FORMAT_LINUX_OUTPUT, oudir, p->getName().c_str()));
+      pool.add({COMMAND_CONVERT, COMMAND_RESIZE, size, path, outputs.back()});
     }
+
+    // Children resize different images concurrently; stderr rows are passed through.
+    pool.execute(
+        [](Jsize, const std::string &row, Jbool error) {
+          if (error)
+            fprintf(stderr, "%s\n", row.c_str());
+        },
+        [&](Jsize index, Jint status) {
+          if ((status == 0) && File::isExist(outputs[index]))
+            journal.add(paths[index], {outputs[index]});
+          else
+            Log::error(FORMAT_FAILED, paths[index].c_str());
+          prog.updateOne();
+        });
     return 0;
   }
 };
 
 class TensorflowReplace : public AbstractCommand {
 private:
+  constexpr static Jchar OPTION_SHARDS[] = "shards";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
   FILE *mOldFile;
   FILE *mNewFile;
 
+  static Jint replace(const std::string &path, const std::string &symbol) {
+    TFCSVRow row;
+    ColumnWriter out;
+    Jfloat points[8] = {};
+    Juint models[3] = {};
+
+    auto &&in = ColumnFile(path);
+    if (!in.isOpen())
+      return -1;
+
+    auto &&labels = in.getLabelNames();
+    auto &&classificationCount = std::vector<Jfloat>(labels.size());
+    auto &&classificationTotal = std::vector<Jfloat>(labels.size());
+    auto &&label = in.getLabel();
+    for (auto &&one : label) {
+      if (one < labels.size())
+        ++classificationTotal[one];
+    }
+
+    models[0] = out.getModel(TFCSVRow::TARGET_TRAIN);
+    models[1] = out.getModel(TFCSVRow::TARGET_VALIDATION);
+    models[2] = out.getModel(TFCSVRow::TARGET_TEST);
+    for (Jsize i = 0; i < labels.size(); ++i)
+      out.getLabel(std::string(labels[i]));
+    out.reserve(in.getRows(), in.getImages());
+
+    auto &&prog = Program(in.getImages());
+    auto &&offsets = in.getOffsets();
+    for (Jsize i = 0; i < in.getImages(); ++i) {
+      row.setPath(std::string(in.getPaths()[i]));
+      row.replacePath(symbol);
+      auto &&image = out.addImage(row.getPath(), in.getWidth()[i], in.getHeight()[i]);
+
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+        auto &&target = label[j];
+        if (target >= labels.size())
+          continue;
+
+        auto &&remainder = classificationCount[target] / classificationTotal[target];
+        auto &&model = (remainder < 0.6) ? models[0] : (remainder < 0.8) ? models[1] : models[2];
+        ++classificationCount[target];
+        in.getPoints(j, points);
+        out.add(image, model, target, points);
+      }
+      prog.updateOne();
+    }
+
+    return out.exported(path) ? 0 : -1;
+  }
+
 public:
   explicit TensorflowReplace(const Jchar *v) : AbstractCommand(v), mOldFile(), mNewFile() {}
 
@@ -198,22 +557,15 @@ public:
       fclose(this->mNewFile);
   }
 
-  Jint execute(const UP<ICommandArgs> &v) override {
+  // Points every row at symbol and splits each label's rows 60/20/20 into train, validation
+  // and test in row order.
+  static void assign(std::list<TFCSVRow> &rows, const std::string &symbol) {
     std::map<std::string, Jfloat> classificationCount;
     std::map<std::string, Jfloat> classificationTotal;
     std::map<std::string, std::list<TFCSVRow *>> classification;
 
-    if (v->getLength() < 2)
-      return -1;
-
-    auto &&file = (*v)[0];
-    auto &&symbol = (*v)[1];
-
-    auto &&inCSV = make<TFCSV>(file);
-    inCSV->parse();
-
-    auto &&prog = Program(inCSV->getRows().size() * 3);
-    for (auto &&row : inCSV->getRows()) {
+    auto &&prog = Program(rows.size() * 3);
+    for (auto &&row : rows) {
       row.replacePath(symbol);
       classification[row.getTarget()].emplace_back(&row);
       prog.updateOne();
@@ -240,148 +592,424 @@ public:
         prog.updateOne();
       }
     }
+  }
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&file = (*v)[0];
+    auto &&symbol = (*v)[1];
+
+    if (std::filesystem::path(file).extension() == ColumnFile::SURRFIX)
+      return replace(file, symbol);
+
+    Jint shards = 0;
+    if (v->getOption(OPTION_SHARDS) != nullptr) {
+      shards = ShardedCSV::getCount(v->getOption(OPTION_SHARDS));
+      if (shards == 0)
+        return -1;
+    }
+
+    auto &&inCSV = make<TFCSV>(file);
+    if (!inCSV->parse())
+      return -1;
+    assign(inCSV->getRows(), symbol);
+
+    if (shards == 0)
+      return TFCSV::exported(inCSV, file);
 
-    return TFCSV::exported(inCSV, file);
+    auto &&out = ShardedCSV(file, shards, Parallel::getConcurrency(v->getOption(OPTION_THREADS)));
+    for (auto &&row : inCSV->getRows())
+      out.add(TFCSV::getRow(row));
+    return out.close() ? 0 : -1;
   }
 };
 
 class TensorflowCSV : public AbstractCommand {
 private:
+  constexpr static Jsize SIZE_BLOCK = 1024;
+  constexpr static Jint WATCH_SETTLE = 50;
+  constexpr static Jint WATCH_BATCH = 500;
+
   constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar OPTION_WATCH[] = "watch";
+  constexpr static Jchar OPTION_SHARDS[] = "shards";
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+  constexpr static Jchar MODEL_APPEND[] = "ab";
+  constexpr static Jchar FORMAT_WATCH[] = "file: %s, watching %s";
+  constexpr static Jchar FORMAT_UPDATE[] = "file: %s, changed: %zu, removed: %zu, %s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, watch failed";
+  constexpr static Jchar FORMAT_WRITE[] = "file: %s, write failed";
+  constexpr static Jchar MARK_REWRITE[] = "rewritten";
+  constexpr static Jchar MARK_APPEND[] = "appended";
+
+  // Parses paths on the BatchReader workers and leaves the rows of paths[i] in rows[i].
+  static void parse(const std::vector<std::string> &paths, Jint threads,
+                    const std::string &target, std::vector<LabelImageArena> &arenas,
+                    std::vector<std::string> &rows) {
+    rows.resize(paths.size());
+    BatchReader::forEach(paths, threads, [&](Jsize i, std::string &data, Jint worker) {
+      arenas[worker].parse(data);
+      rows[i].clear();
+      add(rows[i], arenas[worker], target);
+    });
+  }
+
+  // Same key the initial build gets from getFilesInDirectory, however dir is spelled.
+  static std::string getPath(const std::string &dir, const std::string &name) {
+    auto &&path = std::filesystem::path(dir) / name;
+    return FileAttributes(path.parent_path().string(), name).getAbstractPath();
+  }
+
+  static Jbool rewrite(const std::string &out, const std::vector<std::string> &order,
+                       const std::map<std::string, std::string> &rows) {
+    auto &&temp = out + SURRFIX_TEMP;
+    auto &&output =
+        OutputFile(temp, Gzip::isGzip(out), MODEL_WRITER_ONLY, Parallel::getConcurrency());
+    if (!output.isOpen())
+      return false;
+
+    for (auto &&path : order)
+      output.write(rows.at(path));
+    if (output.close() && (rename(temp.c_str(), out.c_str()) == 0))
+      return true;
+
+    File::remove(temp);
+    return false;
+  }
+
+  static Jbool append(const std::string &out, const std::vector<std::string> &rows) {
+    std::string all;
+
+    for (auto &&one : rows)
+      all.append(one);
+
+    // A .gz export grows by one more gzip member.
+    auto &&output = OutputFile(out, Gzip::isGzip(out), MODEL_APPEND);
+    if (!output.isOpen())
+      return false;
+
+    output.write(all);
+    return output.close();
+  }
+
+  // Keeps out in step with dir after the full build: rows stay in memory per file, and each
+  // settled batch of events only re-parses the files it names. New files are appended;
+  // edits and deletions rewrite the CSV through a temporary file and a rename. watcher was
+  // opened before the build, so files saved while it ran are in the first batch.
+  static Jint watch(DirectoryWatch &watcher, const std::string &dir, const std::string &out,
+                    Jint threads, const std::string &target, std::vector<std::string> order,
+                    std::map<std::string, std::string> rows) {
+    std::set<std::string> names;
+    std::vector<std::string> paths;
+    std::vector<std::string> removed;
+    std::vector<std::string> texts;
+    std::vector<LabelImageArena> arenas(threads);
+
+    auto &&collect = [&names](const std::string &name) {
+      if (Gzip::getExtension(name) == SURRFIX)
+        names.insert(name);
+    };
+
+    Log::info(FORMAT_WATCH, out.c_str(), dir.c_str());
+    fflush(stdout);
+    while (true) {
+      auto count = watcher.wait(-1, collect);
+      auto &&start = std::chrono::steady_clock::now();
+      while (count >= 0) {
+        auto &&elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (elapsed.count() >= WATCH_BATCH)
+          break;
+
+        auto &&more = watcher.wait(WATCH_SETTLE, collect);
+        if (more < 0)
+          count = -1;
+        else if (more == 0)
+          break;
+      }
+
+      // Events were lost; every file is checked again, unchanged ones cost nothing below.
+      if (count < 0) {
+        UP<File> file(new File());
+        for (auto &&one : file->getFilesInDirectory<SURRFIX>(dir))
+          names.insert(one->getName());
+        for (auto &&one : order)
+          names.insert(std::filesystem::path(one).filename().string());
+      }
+
+      paths.clear();
+      removed.clear();
+      for (auto &&name : names) {
+        auto &&path = getPath(dir, name);
+        if (File::isExist(path))
+          paths.push_back(path);
+        else if (rows.count(path) != 0)
+          removed.push_back(path);
+      }
+      names.clear();
+      parse(paths, threads, target, arenas, texts);
+
+      Jbool dirty = !removed.empty();
+      std::vector<std::string> added;
+      for (Jsize i = 0; i < paths.size(); ++i) {
+        auto &&it = rows.find(paths[i]);
+        if (it == rows.end()) {
+          order.push_back(paths[i]);
+          added.push_back(texts[i]);
+          rows.emplace(paths[i], move(texts[i]));
+        } else if (it->second != texts[i]) {
+          it->second = move(texts[i]);
+          dirty = true;
+        }
+      }
+      for (auto &&path : removed)
+        rows.erase(path);
+      if (!removed.empty()) {
+        order.erase(std::remove_if(order.begin(), order.end(),
+                                   [&rows](const std::string &v) { return rows.count(v) == 0; }),
+                    order.end());
+      }
+
+      if (!dirty && added.empty())
+        continue;
+      if (dirty ? rewrite(out, order, rows) : append(out, added))
+        Log::info(FORMAT_UPDATE, out.c_str(), paths.size(), removed.size(),
+                  dirty ? MARK_REWRITE : MARK_APPEND);
+      else
+        Log::error(FORMAT_FAILED, out.c_str());
+      fflush(stdout);
+    }
+  }
 
 public:
   using AbstractCommand::AbstractCommand;
 
+  // Appends the TFCSV rows of one parsed annotation, labelled target when it is set.
+  static void add(std::string &rows, const LabelImageArena &xml, const std::string &target) {
+    auto &&width = xml.getSize().getWidth();
+    auto &&height = xml.getSize().getHeight();
+    auto &&filename = std::string(xml.getFilename());
+
+    for (auto &&object : xml.getObjects()) {
+      auto &&name = std::string(object.getName());
+      auto &&minX = object.getBndbox().getMinX();
+      auto &&minY = object.getBndbox().getMinY();
+      auto &&maxX = object.getBndbox().getMaxX();
+      auto &&maxY = object.getBndbox().getMaxY();
+
+      auto &&newTarget = target.empty() ? name : target;
+      auto &&format = GoogleCloudCSVFormat(width, height, minX, minY, maxX, maxY, filename,
+                                           newTarget, TFCSVRow::SYMBOL_MARK, TFCSVRow::SYMBOL_PATH);
+      rows.append(format.getRow());
+    }
+  }
+
   Jint execute(const UP<ICommandArgs> &v) override {
     std::string target;
+    std::vector<std::string> paths;
+    std::vector<std::string> block;
+    std::vector<std::string> texts;
+    std::map<std::string, std::string> rows;
 
     UP<File> file(new File());
+    UP<ShardedCSV> shards = nullptr;
     SP<GoogleCloudCSV> csv = nullptr;
-    SP<LabelImageXML> xml = nullptr;
 
     if (v->getLength() < 2)
       return -1;
     if (v->getLength() == 3)
       target = (*v)[2];
 
-    auto &&list = file->getFilesInDirectory<SURRFIX>((*v)[0]);
-    auto &&prog = Program(list.size());
-    csv = make<GoogleCloudCSV>((list.size() * 3), (*v)[1]);
-
-    for (auto &&path : list) {
-      xml = make<LabelImageXML>(path->getAbstractPath());
-      auto &&width = xml->getSize().getWidth();
-      auto &&height = xml->getSize().getHeight();
-      auto &&filename = xml->getFilename();
-
-      for (auto &&object : xml->getObjects()) {
-        auto &&name = object.getName();
-        auto &&minX = object.getBndbox().getMinX();
-        auto &&minY = object.getBndbox().getMinY();
-        auto &&maxX = object.getBndbox().getMaxX();
-        auto &&maxY = object.getBndbox().getMaxY();
-
-        auto &&newTarget = target.empty() ? name : target;
-        auto &&format =
-            GoogleCloudCSVFormat(width, height, minX, minY, maxX, maxY, filename, newTarget,
-                                 TFCSVRow::SYMBOL_MARK, TFCSVRow::SYMBOL_PATH);
-        csv->add(format);
+    auto &&watching = v->hasOption(OPTION_WATCH);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    if (watching && (v->getOption(OPTION_SHARDS) != nullptr))
+      return -1;
+
+    // Opened before the scan so that nothing saved during the build is missed.
+    UP<DirectoryWatch> watcher = nullptr;
+    if (watching) {
+      watcher.reset(new DirectoryWatch((*v)[0]));
+      if (!watcher->isOpen()) {
+        Log::error(FORMAT_FAILED, (*v)[0]);
+        return -1;
       }
+    }
 
-      prog.updateOne();
+    auto &&arenas = std::vector<LabelImageArena>(threads);
+    for (auto &&one : file->getFilesInDirectory<SURRFIX>((*v)[0]))
+      paths.push_back(one->getAbstractPath());
+
+    Jint count = 0;
+    if (v->getOption(OPTION_SHARDS) != nullptr) {
+      count = ShardedCSV::getCount(v->getOption(OPTION_SHARDS));
+      if (count == 0)
+        return -1;
     }
 
-    return 0;
+    auto &&prog = Program(paths.size());
+    if (count > 0) {
+      shards = UP<ShardedCSV>(new ShardedCSV((*v)[1], count, threads));
+    } else {
+      csv = make<GoogleCloudCSV>((paths.size() * 3), (*v)[1]);
+      if (!csv->isOpen()) {
+        Log::error(FORMAT_WRITE, (*v)[1]);
+        return -1;
+      }
+    }
+
+    // Files of a block load concurrently; rows are still written in directory order.
+    for (Jsize begin = 0; begin < paths.size(); begin += SIZE_BLOCK) {
+      auto end = std::min(paths.size(), begin + SIZE_BLOCK);
+      block.assign(paths.begin() + begin, paths.begin() + end);
+      parse(block, threads, target, arenas, texts);
+
+      for (Jsize i = 0; i < block.size(); ++i) {
+        if (shards != nullptr)
+          shards->add(texts[i]);
+        else
+          csv->add(texts[i]);
+        if (watching)
+          rows[block[i]] = move(texts[i]);
+      }
+      prog.update(static_cast<Jint>(end - begin));
+    }
+
+    if ((shards != nullptr) && !shards->close()) {
+      Log::error(FORMAT_WRITE, (*v)[1]);
+      return -1;
+    }
+    if (shards != nullptr)
+      return 0;
+    if (!csv->close()) {
+      Log::error(FORMAT_WRITE, (*v)[1]);
+      return -1;
+    }
+    if (!watching)
+      return 0;
+    return watch(*watcher, (*v)[0], (*v)[1], threads, target, move(paths), move(rows));
   }
 };
 
 class TensorflowTransform : public AbstractCommand {
 private:
   constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar OPTION_PIXELS[] = "pixels";
+  constexpr static Jchar OPTION_RESUME[] = "resume";
   constexpr static Jchar FORMAT_NEW_XML_PATH[] = "%s/%s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, image open failed";
+  constexpr static Jchar FORMAT_JOURNAL[] = "file: %s, journal open failed, progress is not saved";
 
   constexpr static Jchar MODEL_CROP[] = "crop";
   constexpr static Jchar MODEL_OFFSET[] = "offset";
 
-  static void converCrop(const SP<LabelImageXML> &v) {
-    LabelImageConver object(v);
-
-    object.execute<CROP_TOP_10>();
-    object.execute<CROP_TOP_20>();
-    object.execute<CROP_TOP_30>();
-    object.execute<CROP_TOP_40>();
-
-    object.execute<CROP_BOTTOM_10>();
-    object.execute<CROP_BOTTOM_20>();
-    object.execute<CROP_BOTTOM_30>();
-    object.execute<CROP_BOTTOM_40>();
-
-    object.execute<CROP_LEFT_10>();
-    object.execute<CROP_LEFT_20>();
-    object.execute<CROP_LEFT_30>();
-    object.execute<CROP_LEFT_40>();
+  template <class T> static void converCrop(T &object) {
+    object.template execute<CROP_TOP_10>();
+    object.template execute<CROP_TOP_20>();
+    object.template execute<CROP_TOP_30>();
+    object.template execute<CROP_TOP_40>();
+
+    object.template execute<CROP_BOTTOM_10>();
+    object.template execute<CROP_BOTTOM_20>();
+    object.template execute<CROP_BOTTOM_30>();
+    object.template execute<CROP_BOTTOM_40>();
+
+    object.template execute<CROP_LEFT_10>();
+    object.template execute<CROP_LEFT_20>();
+    object.template execute<CROP_LEFT_30>();
+    object.template execute<CROP_LEFT_40>();
+
+    object.template execute<CROP_RIGHT_10>();
+    object.template execute<CROP_RIGHT_20>();
+    object.template execute<CROP_RIGHT_30>();
+    object.template execute<CROP_RIGHT_40>();
+
+    object.template execute<CROP_LEFT_10 | CROP_TOP_10>();
+    object.template execute<CROP_LEFT_10 | CROP_TOP_20>();
+    object.template execute<CROP_LEFT_20 | CROP_TOP_10>();
+    object.template execute<CROP_LEFT_20 | CROP_TOP_20>();
+
+    object.template execute<CROP_RIGHT_10 | CROP_TOP_10>();
+    object.template execute<CROP_RIGHT_10 | CROP_TOP_20>();
+    object.template execute<CROP_RIGHT_20 | CROP_TOP_10>();
+    object.template execute<CROP_RIGHT_20 | CROP_TOP_20>();
+
+    object.template execute<CROP_LEFT_10 | CROP_BOTTOM_10>();
+    object.template execute<CROP_LEFT_10 | CROP_BOTTOM_20>();
+    object.template execute<CROP_LEFT_20 | CROP_BOTTOM_10>();
+    object.template execute<CROP_LEFT_20 | CROP_BOTTOM_20>();
+
+    object.template execute<CROP_RIGHT_10 | CROP_BOTTOM_10>();
+    object.template execute<CROP_RIGHT_10 | CROP_BOTTOM_20>();
+    object.template execute<CROP_RIGHT_20 | CROP_BOTTOM_10>();
+    object.template execute<CROP_RIGHT_20 | CROP_BOTTOM_20>();
+
+    object.template execute<CROP_RIGHT_10 | CROP_LEFT_10>();
+    object.template execute<CROP_RIGHT_20 | CROP_LEFT_20>();
+
+    object.template execute<CROP_TOP_10 | CROP_BOTTOM_10>();
+    object.template execute<CROP_TOP_20 | CROP_BOTTOM_20>();
+
+    object.template execute<CROP_TOP_10 | CROP_BOTTOM_10 | CROP_RIGHT_10 | CROP_LEFT_10>();
+    object.template execute<CROP_TOP_20 | CROP_BOTTOM_20 | CROP_RIGHT_20 | CROP_LEFT_20>();
+  }
 
-    object.execute<CROP_RIGHT_10>();
-    object.execute<CROP_RIGHT_20>();
-    object.execute<CROP_RIGHT_30>();
-    object.execute<CROP_RIGHT_40>();
+  template <class T> static void convertOffset(T &object) {
+    object.template execute<OFFSET_TOP_10>();
+    object.template execute<OFFSET_TOP_20>();
 
-    object.execute<CROP_LEFT_10 | CROP_TOP_10>();
-    object.execute<CROP_LEFT_10 | CROP_TOP_20>();
-    object.execute<CROP_LEFT_20 | CROP_TOP_10>();
-    object.execute<CROP_LEFT_20 | CROP_TOP_20>();
+    object.template execute<OFFSET_BOTTOM_10>();
+    object.template execute<OFFSET_BOTTOM_20>();
 
-    object.execute<CROP_RIGHT_10 | CROP_TOP_10>();
-    object.execute<CROP_RIGHT_10 | CROP_TOP_20>();
-    object.execute<CROP_RIGHT_20 | CROP_TOP_10>();
-    object.execute<CROP_RIGHT_20 | CROP_TOP_20>();
+    object.template execute<OFFSET_LEFT_10>();
+    object.template execute<OFFSET_LEFT_20>();
 
-    object.execute<CROP_LEFT_10 | CROP_BOTTOM_10>();
-    object.execute<CROP_LEFT_10 | CROP_BOTTOM_20>();
-    object.execute<CROP_LEFT_20 | CROP_BOTTOM_10>();
-    object.execute<CROP_LEFT_20 | CROP_BOTTOM_20>();
+    object.template execute<OFFSET_RIGHT_10>();
+    object.template execute<OFFSET_RIGHT_20>();
 
-    object.execute<CROP_RIGHT_10 | CROP_BOTTOM_10>();
-    object.execute<CROP_RIGHT_10 | CROP_BOTTOM_20>();
-    object.execute<CROP_RIGHT_20 | CROP_BOTTOM_10>();
-    object.execute<CROP_RIGHT_20 | CROP_BOTTOM_20>();
+    object.template execute<OFFSET_TOP_10 | OFFSET_LEFT_10>();
+    object.template execute<OFFSET_TOP_20 | OFFSET_LEFT_20>();
 
-    object.execute<CROP_RIGHT_10 | CROP_LEFT_10>();
-    object.execute<CROP_RIGHT_20 | CROP_LEFT_20>();
+    object.template execute<OFFSET_TOP_20 | OFFSET_RIGHT_10>();
+    object.template execute<OFFSET_TOP_20 | OFFSET_RIGHT_20>();
 
-    object.execute<CROP_TOP_10 | CROP_BOTTOM_10>();
-    object.execute<CROP_TOP_20 | CROP_BOTTOM_20>();
+    object.template execute<OFFSET_BOTTOM_10 | OFFSET_LEFT_10>();
+    object.template execute<OFFSET_BOTTOM_20 | OFFSET_LEFT_20>();
 
-    object.execute<CROP_TOP_10 | CROP_BOTTOM_10 | CROP_RIGHT_10 | CROP_LEFT_10>();
-    object.execute<CROP_TOP_20 | CROP_BOTTOM_20 | CROP_RIGHT_20 | CROP_LEFT_20>();
+    object.template execute<OFFSET_BOTTOM_10 | OFFSET_RIGHT_10>();
+    object.template execute<OFFSET_BOTTOM_20 | OFFSET_RIGHT_20>();
   }
 
-  static void convertOffset(SP<LabelImageXML> const &v) {
-    LabelImageConver object(v);
-
-    object.execute<OFFSET_TOP_10>();
-    object.execute<OFFSET_TOP_20>();
-
-    object.execute<OFFSET_BOTTOM_10>();
-    object.execute<OFFSET_BOTTOM_20>();
-
-    object.execute<OFFSET_LEFT_10>();
-    object.execute<OFFSET_LEFT_20>();
-
-    object.execute<OFFSET_RIGHT_10>();
-    object.execute<OFFSET_RIGHT_20>();
-
-    object.execute<OFFSET_TOP_10 | OFFSET_LEFT_10>();
-    object.execute<OFFSET_TOP_20 | OFFSET_LEFT_20>();
-
-    object.execute<OFFSET_TOP_20 | OFFSET_RIGHT_10>();
-    object.execute<OFFSET_TOP_20 | OFFSET_RIGHT_20>();
+  template <class T> static void variants(T &object, const Jchar *model) {
+    if (strcmp(model, MODEL_CROP) == 0)
+      converCrop(object);
+    else if (strcmp(model, MODEL_OFFSET) == 0)
+      convertOffset(object);
+  }
 
-    object.execute<OFFSET_BOTTOM_10 | OFFSET_LEFT_10>();
-    object.execute<OFFSET_BOTTOM_20 | OFFSET_LEFT_20>();
+  static void convert(const SP<LabelImageXML> &xml, const Jchar *model) {
+    LabelImageConver object(xml);
+    variants(object, model);
+  }
 
-    object.execute<OFFSET_BOTTOM_10 | OFFSET_RIGHT_10>();
-    object.execute<OFFSET_BOTTOM_20 | OFFSET_RIGHT_20>();
+  // Writes every variant as its own image and XML named name-model-NN into out and returns
+  // the written files, or nothing when the image could not be opened.
+  static std::vector<std::string> convert(const SP<LabelImageXML> &xml, const std::string &path,
+                                          const Jchar *model, const std::filesystem::path &out,
+                                          const std::string &name, Jbool &opened) {
+    auto &&image = LabelImageXMLImage::getPath(path, *xml);
+    auto &&object = LabelImagePixels(xml, image, out, name + "-" + model);
+    opened = object.isOpen();
+    if (!opened) {
+      Log::error(FORMAT_FAILED, path.c_str());
+      return {};
+    }
+    variants(object, model);
+    return object.getOutputs();
   }
 
 public:
@@ -396,35 +1024,62 @@ public:
     auto &&in = (*v)[0];
     auto &&out = (*v)[1];
     auto &&model = (*v)[2];
+    auto &&pixels = v->hasOption(OPTION_PIXELS);
 
     if (File::isFile(in) && File::isFile(out)) {
       xml = make<LabelImageXML>(in);
 
-      if (strcmp(model, MODEL_CROP) == 0)
-        converCrop(xml);
-      else if (strcmp(model, MODEL_OFFSET) == 0)
-        convertOffset(xml);
+      if (pixels) {
+        Jbool opened = false;
+        auto &&target = std::filesystem::path(out);
+        auto &&parent = target.has_parent_path() ? target.parent_path() : ".";
+        convert(xml, in, model, parent, target.stem().string(), opened);
+        return opened ? 0 : -1;
+      }
 
+      convert(xml, model);
       LabelImageXMLExporter(xml, out).exported();
       return 0;
     } else if ((!File::isFile(in)) && (!File::isFile(out))) {
+      std::vector<std::string> paths;
+      std::vector<std::string> outs;
       UP<File> file(new File());
 
-      auto &&list = file->getFilesInDirectory<SURRFIX>(in);
-      Program prog(list.size());
-      for (auto &&f : list) {
-        auto &&newPath = String::format(FORMAT_NEW_XML_PATH, out, f->getName().data());
-        xml = make<LabelImageXML>(f->getAbstractPath());
-
-        if (strcmp(model, MODEL_CROP) == 0)
-          converCrop(xml);
-        else if (strcmp(model, MODEL_OFFSET) == 0)
-          convertOffset(xml);
+      Journal journal(out, this->getName(), v->hasOption(OPTION_RESUME));
+      if (!journal.isOpen())
+        Log::error(FORMAT_JOURNAL, journal.getPath().c_str());
+      for (auto &&f : file->getFilesInDirectory<SURRFIX>(in)) {
+        auto &&path = f->getAbstractPath();
+        if (journal.isDone(path))
+          continue;
+        paths.push_back(path);
+        outs.push_back(String::format(FORMAT_NEW_XML_PATH, out, f->getName().data()));
+      }
 
-        LabelImageXMLExporter(xml, newPath).exported();
+      // Workers decode, crop and encode different files concurrently in --pixels mode.
+      std::atomic<Jint> failed(0);
+      Program prog(paths.size());
+      auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+      BatchReader::forEach(paths, threads, [&](Jsize i, std::string &data, Jint) {
+        auto &&one = make<LabelImageXML>(data.data(), data.size());
+
+        if (pixels) {
+          Jbool opened = false;
+          auto &&name = std::filesystem::path(paths[i]).stem().string();
+          auto &&written = convert(one, paths[i], model, out, name, opened);
+          if (opened)
+            journal.add(paths[i], written);
+          else
+            ++failed;
+        } else {
+          convert(one, model);
+          LabelImageXMLExporter(one, outs[i]).exported();
+          if (File::isExist(outs[i]))
+            journal.add(paths[i], {outs[i]});
+        }
         prog.updateOne();
-      }
-      return 0;
+      });
+      return (failed == 0) ? 0 : -1;
     } else {
       return -1;
     }
@@ -432,6 +1087,44 @@ public:
 };
 
 class TensorflowReplaceObject : public AbstractCommand {
+private:
+  static Jint replace(const std::string &path, const std::string &name, const std::string &value) {
+    ColumnWriter out;
+    Jfloat points[8] = {};
+    std::vector<Juint> models;
+    std::vector<Juint> labels;
+
+    auto &&in = ColumnFile(path);
+    if (!in.isOpen())
+      return -1;
+
+    for (Jsize i = 0; i < in.getModelNames().size(); ++i)
+      models.push_back(out.getModel(std::string(in.getModelNames()[i])));
+    for (Jsize i = 0; i < in.getLabelNames().size(); ++i) {
+      auto &&label = std::string(in.getLabelNames()[i]);
+      labels.push_back(out.getLabel((label == name) ? value : label));
+    }
+    out.reserve(in.getRows(), in.getImages());
+
+    auto &&prog = Program(in.getImages());
+    auto &&offsets = in.getOffsets();
+    auto &&model = in.getModel();
+    auto &&label = in.getLabel();
+    for (Jsize i = 0; i < in.getImages(); ++i) {
+      auto &&image =
+          out.addImage(std::string(in.getPaths()[i]), in.getWidth()[i], in.getHeight()[i]);
+      for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+        if ((model[j] >= models.size()) || (label[j] >= labels.size()))
+          continue;
+        in.getPoints(j, points);
+        out.add(image, models[model[j]], labels[label[j]], points);
+      }
+      prog.updateOne();
+    }
+
+    return out.exported(path) ? 0 : -1;
+  }
+
 public:
   using AbstractCommand::AbstractCommand;
 
@@ -445,9 +1138,12 @@ public:
 
     if (std::filesystem::is_directory(file))
       return -1;
+    if (std::filesystem::path(file).extension() == ColumnFile::SURRFIX)
+      return replace(file, name, value);
 
     auto &&csv = make<TFCSV>(file);
-    csv->parse();
+    if (!csv->parse())
+      return -1;
 
     auto &&prog = Program(csv->getRows().size());
     for (auto &&row : csv->getRows()) {
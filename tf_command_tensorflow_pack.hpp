@@ -0,0 +1,225 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_PACK_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_PACK_HPP
+
+namespace tfutils {
+
+// Packs a dataset directory into tar archives in one pass. Images are streamed with sendfile;
+// annotations are read once, archived from memory and parsed from the same buffer, so the
+// replaced CSV can close the last archive. With --split=MiB the archives are a-00000.tar,
+// a-00001.tar and so on, and the files of one image (img0.png, img0.xml) share an archive.
+class TensorflowPack : public AbstractCommand {
+private:
+  constexpr static Jsize SIZE_MEBI = 1024 * 1024;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar SURRFIX_CSV[] = ".csv";
+  constexpr static Jchar SURRFIX_TEMP[] = ".tmp";
+  constexpr static Jchar OPTION_SPLIT[] = "split";
+  constexpr static Jchar FORMAT_VOLUME[] = "%s-%05d%s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, pack failed";
+  constexpr static Jchar FORMAT_DONE[] = "file: %s, files: %d, bytes: %lld";
+
+  class Entry {
+  public:
+    std::string mName;
+    std::string mPath;
+    Jsize mSize;
+    Jlong mTime;
+  };
+
+  Jint mVolumes;
+  Jint mFiles;
+  Jsize mLimit;
+  std::string mName;
+  std::filesystem::path mOut;
+  UP<TarWriter> mTar;
+
+  std::string getVolume() const {
+    if (this->mLimit == 0)
+      return this->mOut.string();
+
+    auto &&prefix = (this->mOut.parent_path() / this->mOut.stem()).string();
+    auto &&extension = this->mOut.extension().string();
+    return String::format(FORMAT_VOLUME, prefix.c_str(), this->mVolumes, extension.c_str());
+  }
+
+  Jbool open() {
+    this->mName = this->getVolume();
+    this->mTar.reset(new TarWriter(this->mName + SURRFIX_TEMP));
+    this->mFiles = 0;
+    if (this->mTar->isOpen())
+      return true;
+
+    Log::error(FORMAT_FAILED, this->mName.c_str());
+    return false;
+  }
+
+  Jbool close() {
+    auto &&temp = this->mName + SURRFIX_TEMP;
+    auto &&size = this->mTar->getSize();
+
+    auto &&ret = this->mTar->close();
+    this->mTar.reset();
+    ++this->mVolumes;
+    if (!ret || (rename(temp.c_str(), this->mName.c_str()) != 0)) {
+      Log::error(FORMAT_FAILED, this->mName.c_str());
+      File::remove(temp);
+      return false;
+    }
+
+    Log::info(FORMAT_DONE, this->mName.c_str(), this->mFiles, size);
+    return true;
+  }
+
+  // Drops the archive being written after a failure.
+  void discard() {
+    this->mTar.reset();
+    File::remove(this->mName + SURRFIX_TEMP);
+  }
+
+  // Starts the next archive when size more bytes would push a non-empty one past the limit.
+  Jbool reserve(Jsize size) {
+    if ((this->mLimit == 0) || (this->mFiles == 0))
+      return true;
+    if (this->mTar->getSize() + size + TarWriter::getEndSize() <= this->mLimit)
+      return true;
+    return this->close() && this->open();
+  }
+
+  static std::vector<Entry> list(const std::string &in) {
+    File file;
+    struct stat info = {};
+    std::vector<Entry> ret;
+
+    for (auto &&one : file.getFilesInDirectory(in)) {
+      auto &&path = one->getAbstractPath();
+      if ((stat(path.c_str(), &info) != 0) || !S_ISREG(info.st_mode))
+        continue;
+      ret.push_back({one->getName(), path, static_cast<Jsize>(info.st_size), info.st_mtime});
+    }
+
+    std::sort(ret.begin(), ret.end(),
+              [](const Entry &a, const Entry &b) { return a.mName < b.mName; });
+    return ret;
+  }
+
+  // Sorted by name, img0.png and img0.xml sit next to each other.
+  static std::string_view getGroup(const std::string &name) {
+    return std::string_view(name).substr(0, name.find('.'));
+  }
+
+  // Plain annotations are archived from the buffer they are parsed from; everything else,
+  // .xml.gz annotations included, goes through sendfile.
+  Jbool add(const Entry &entry, Jbool csv, LabelImageArena &arena, std::string &data,
+            std::string &rows) {
+    auto &&extension = std::filesystem::path(entry.mName).extension();
+    auto &&annotation = csv && (extension == SURRFIX);
+    auto &&compressed =
+        csv && Gzip::isGzip(entry.mName) && (Gzip::getExtension(entry.mName) == SURRFIX);
+
+    if (annotation) {
+      if (!File::read(entry.mPath, data) ||
+          !this->mTar->add(entry.mName, data.data(), data.size(), entry.mTime))
+        return false;
+      if (arena.parse(data))
+        TensorflowCSV::add(rows, arena, std::string());
+    } else {
+      if (!this->mTar->add(entry.mName, entry.mPath))
+        return false;
+      if (compressed && arena.load(entry.mPath))
+        TensorflowCSV::add(rows, arena, std::string());
+    }
+
+    ++this->mFiles;
+    return true;
+  }
+
+  // Rows get the same symbol and split assignment replace would give them.
+  Jbool addCsv(const std::string &rows, const std::string &symbol) {
+    std::string buffer;
+    std::string content;
+    TFCSVRow row;
+
+    auto &&csv = TFCSV(std::string());
+    for (Jsize begin = 0, end = 0; begin < rows.size(); begin = end + 1) {
+      end = std::min(rows.find('\n', begin), rows.size());
+      if (TFCSV::parseLine(std::string_view(&rows[begin], end - begin), row, buffer))
+        csv.addRow(row);
+    }
+
+    TensorflowReplace::assign(csv.getRows(), symbol);
+    for (auto &&one : csv.getRows())
+      content.append(TFCSV::getRow(one));
+
+    auto &&name = this->mOut.stem().string() + SURRFIX_CSV;
+    if (!this->reserve(TarWriter::getEntrySize(name, content.size())))
+      return false;
+    if (!this->mTar->add(name, content.data(), content.size(), time(nullptr)))
+      return false;
+    ++this->mFiles;
+    return true;
+  }
+
+  Jint execute(const std::string &in, const std::string &symbol) {
+    std::string data;
+    std::string rows;
+    LabelImageArena arena;
+
+    auto &&entries = list(in);
+    auto &&csv = !symbol.empty();
+    auto &&prog = Program(entries.size());
+
+    if (!this->open())
+      return -1;
+
+    for (Jsize begin = 0, end = 0; begin < entries.size(); begin = end) {
+      Jsize size = 0;
+      auto &&group = getGroup(entries[begin].mName);
+      for (end = begin; (end < entries.size()) && (getGroup(entries[end].mName) == group); ++end)
+        size += TarWriter::getEntrySize(entries[end].mName, entries[end].mSize);
+      if (!this->reserve(size)) {
+        this->discard();
+        return -1;
+      }
+
+      for (auto i = begin; i < end; ++i) {
+        if (!this->add(entries[i], csv, arena, data, rows)) {
+          Log::error(FORMAT_FAILED, entries[i].mPath.c_str());
+          this->discard();
+          return -1;
+        }
+        prog.updateOne();
+      }
+    }
+
+    if (csv && !this->addCsv(rows, symbol)) {
+      this->discard();
+      return -1;
+    }
+    return this->close() ? 0 : -1;
+  }
+
+public:
+  explicit TensorflowPack(const Jchar *v)
+      : AbstractCommand(v), mVolumes(), mFiles(), mLimit(), mName(), mOut(), mTar() {}
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    std::string symbol;
+
+    if (v->getLength() < 2)
+      return -1;
+    if (File::isFile((*v)[0]))
+      return -1;
+
+    this->mOut = (*v)[1];
+    if (v->getLength() > 2)
+      symbol = (*v)[2];
+    if (v->getOption(OPTION_SPLIT) != nullptr)
+      this->mLimit = std::strtoull(v->getOption(OPTION_SPLIT), nullptr, 10) * SIZE_MEBI;
+    return this->execute((*v)[0], symbol);
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_PACK_HPP
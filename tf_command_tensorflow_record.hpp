@@ -0,0 +1,891 @@
+#ifndef TFUTILS_TF_COMMAND_TENSORFLOW_RECORD_HPP
+#define TFUTILS_TF_COMMAND_TENSORFLOW_RECORD_HPP
+
+namespace tfutils {
+
+class ProtobufWriter {
+private:
+  constexpr static Juint WIRE_VARINT = 0;
+  constexpr static Juint WIRE_LENGTH = 2;
+
+public:
+  static void varint(std::string &out, uint64_t v) {
+    while (v >= 0x80u) {
+      out.push_back(static_cast<Jchar>((v & 0x7fu) | 0x80u));
+      v >>= 7u;
+    }
+    out.push_back(static_cast<Jchar>(v));
+  }
+
+  static void length(std::string &out, Juint field, const Jchar *v, Jsize len) {
+    varint(out, (field << 3u) | WIRE_LENGTH);
+    varint(out, len);
+    out.append(v, len);
+  }
+
+  static void length(std::string &out, Juint field, const std::string &v) {
+    length(out, field, v.data(), v.size());
+  }
+};
+
+class ProtobufReader {
+private:
+  const Jbyte *mData;
+  const Jbyte *mEnd;
+  Jbool mError;
+
+  Jbool varint(uint64_t &v) {
+    Juint shift = 0;
+
+    v = 0;
+    while ((this->mData < this->mEnd) && (shift < 64)) {
+      auto &&byte = *this->mData++;
+      v |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+      if ((byte & 0x80u) == 0)
+        return true;
+      shift += 7;
+    }
+    return false;
+  }
+
+public:
+  constexpr static Juint WIRE_VARINT = 0;
+  constexpr static Juint WIRE_FIXED64 = 1;
+  constexpr static Juint WIRE_LENGTH = 2;
+  constexpr static Juint WIRE_FIXED32 = 5;
+
+  ProtobufReader(const Jbyte *v, Jsize len) : mData(v), mEnd(v + len), mError() {}
+
+  ProtobufReader(std::string_view v)
+      : ProtobufReader(reinterpret_cast<const Jbyte *>(v.data()), v.size()) {}
+
+  [[nodiscard]] Jbool isError() const { return this->mError; }
+
+  Jbool next(Juint &field, Juint &wire, uint64_t &value, std::string_view &bytes) {
+    uint64_t tag = 0;
+
+    if (this->mData >= this->mEnd)
+      return false;
+    if (!this->varint(tag))
+      return !(this->mError = true);
+
+    field = static_cast<Juint>(tag >> 3u);
+    wire = static_cast<Juint>(tag & 7u);
+    if (wire == WIRE_VARINT) {
+      if (!this->varint(value))
+        return !(this->mError = true);
+    } else if ((wire == WIRE_LENGTH) || (wire == WIRE_FIXED64) || (wire == WIRE_FIXED32)) {
+      if ((wire == WIRE_LENGTH) && (!this->varint(value)))
+        return !(this->mError = true);
+      if (wire != WIRE_LENGTH)
+        value = (wire == WIRE_FIXED64) ? 8 : 4;
+      if (value > static_cast<uint64_t>(this->mEnd - this->mData))
+        return !(this->mError = true);
+      bytes = std::string_view(reinterpret_cast<const Jchar *>(this->mData), value);
+      this->mData += value;
+    } else {
+      return !(this->mError = true);
+    }
+    return true;
+  }
+
+  Jbool nextVarint(uint64_t &v) {
+    if (this->mData >= this->mEnd)
+      return false;
+    if (!this->varint(v))
+      return !(this->mError = true);
+    return true;
+  }
+};
+
+class TFExample {
+private:
+  constexpr static Juint FIELD_FEATURES = 1;
+  constexpr static Juint FIELD_ENTRY = 1;
+  constexpr static Juint FIELD_KEY = 1;
+  constexpr static Juint FIELD_VALUE = 2;
+
+  constexpr static Juint FIELD_BYTES_LIST = 1;
+  constexpr static Juint FIELD_FLOAT_LIST = 2;
+  constexpr static Juint FIELD_INT64_LIST = 3;
+  constexpr static Juint FIELD_LIST_VALUE = 1;
+
+  std::string mFeatures;
+  std::string mFeature;
+  std::string mEntry;
+  std::string mList;
+  std::string mContent;
+
+  void entry(const Jchar *key, Juint kind) {
+    this->mFeature.clear();
+    ProtobufWriter::length(this->mFeature, kind, this->mList);
+
+    this->mEntry.clear();
+    ProtobufWriter::length(this->mEntry, FIELD_KEY, key, strlen(key));
+    ProtobufWriter::length(this->mEntry, FIELD_VALUE, this->mFeature);
+    ProtobufWriter::length(this->mFeatures, FIELD_ENTRY, this->mEntry);
+  }
+
+public:
+  constexpr static Jchar KEY_HEIGHT[] = "image/height";
+  constexpr static Jchar KEY_WIDTH[] = "image/width";
+  constexpr static Jchar KEY_FILENAME[] = "image/filename";
+  constexpr static Jchar KEY_SOURCE_ID[] = "image/source_id";
+  constexpr static Jchar KEY_ENCODED[] = "image/encoded";
+  constexpr static Jchar KEY_FORMAT[] = "image/format";
+  constexpr static Jchar KEY_XMIN[] = "image/object/bbox/xmin";
+  constexpr static Jchar KEY_XMAX[] = "image/object/bbox/xmax";
+  constexpr static Jchar KEY_YMIN[] = "image/object/bbox/ymin";
+  constexpr static Jchar KEY_YMAX[] = "image/object/bbox/ymax";
+  constexpr static Jchar KEY_TEXT[] = "image/object/class/text";
+  constexpr static Jchar KEY_LABEL[] = "image/object/class/label";
+
+  TFExample() : mFeatures(), mFeature(), mEntry(), mList(), mContent() {}
+
+  void clean() { this->mFeatures.clear(); }
+
+  void addBytes(const Jchar *key, const Jchar *v, Jsize len) {
+    this->mList.clear();
+    ProtobufWriter::length(this->mList, FIELD_LIST_VALUE, v, len);
+    this->entry(key, FIELD_BYTES_LIST);
+  }
+
+  void addBytes(const Jchar *key, const std::string &v) { this->addBytes(key, v.data(), v.size()); }
+
+  template <class List> void addBytesList(const Jchar *key, const List &v) {
+    this->mList.clear();
+    for (auto &&one : v)
+      ProtobufWriter::length(this->mList, FIELD_LIST_VALUE, one);
+    this->entry(key, FIELD_BYTES_LIST);
+  }
+
+  void addFloatList(const Jchar *key, const std::vector<Jfloat> &v) {
+    this->mList.clear();
+    ProtobufWriter::length(this->mList, FIELD_LIST_VALUE, reinterpret_cast<const Jchar *>(v.data()),
+                           v.size() * sizeof(Jfloat));
+    this->entry(key, FIELD_FLOAT_LIST);
+  }
+
+  void addInt64List(const Jchar *key, const std::vector<Jlong> &v) {
+    std::string packed;
+
+    for (auto &&one : v)
+      ProtobufWriter::varint(packed, static_cast<uint64_t>(one));
+
+    this->mList.clear();
+    ProtobufWriter::length(this->mList, FIELD_LIST_VALUE, packed);
+    this->entry(key, FIELD_INT64_LIST);
+  }
+
+  void addInt64(const Jchar *key, Jlong v) { this->addInt64List(key, std::vector<Jlong>{v}); }
+
+  const std::string &getContent() {
+    this->mContent.clear();
+    ProtobufWriter::length(this->mContent, FIELD_FEATURES, this->mFeatures);
+    return this->mContent;
+  }
+};
+
+class TFExampleReader {
+private:
+  constexpr static Juint FIELD_ENTRY = 1;
+  constexpr static Juint FIELD_KEY = 1;
+  constexpr static Juint FIELD_VALUE = 2;
+
+  constexpr static Juint FIELD_BYTES_LIST = 1;
+  constexpr static Juint FIELD_FLOAT_LIST = 2;
+  constexpr static Juint FIELD_INT64_LIST = 3;
+  constexpr static Juint FIELD_LIST_VALUE = 1;
+
+  Jlong mWidth;
+  Jlong mHeight;
+  Jsize mEncoded;
+
+  std::vector<Jfloat> mXmin;
+  std::vector<Jfloat> mXmax;
+  std::vector<Jfloat> mYmin;
+  std::vector<Jfloat> mYmax;
+  std::vector<std::string_view> mTexts;
+
+  static Jbool bytesList(std::string_view v, std::vector<std::string_view> &out) {
+    Juint field = 0;
+    Juint wire = 0;
+    uint64_t value = 0;
+    std::string_view bytes;
+
+    auto &&reader = ProtobufReader(v);
+    while (reader.next(field, wire, value, bytes)) {
+      if ((field == FIELD_LIST_VALUE) && (wire == ProtobufReader::WIRE_LENGTH))
+        out.push_back(bytes);
+    }
+    return !reader.isError();
+  }
+
+  static Jbool floatList(std::string_view v, std::vector<Jfloat> &out) {
+    Juint field = 0;
+    Juint wire = 0;
+    Jfloat one = 0;
+    uint64_t value = 0;
+    std::string_view bytes;
+
+    auto &&reader = ProtobufReader(v);
+    while (reader.next(field, wire, value, bytes)) {
+      if (field != FIELD_LIST_VALUE)
+        continue;
+      if ((wire != ProtobufReader::WIRE_LENGTH) && (wire != ProtobufReader::WIRE_FIXED32))
+        continue;
+
+      for (Jsize i = 0; (i + sizeof(Jfloat)) <= bytes.size(); i += sizeof(Jfloat)) {
+        memcpy(&one, &bytes[i], sizeof(one));
+        out.push_back(one);
+      }
+    }
+    return !reader.isError();
+  }
+
+  static Jbool int64First(std::string_view v, Jlong &out) {
+    Juint field = 0;
+    Juint wire = 0;
+    uint64_t value = 0;
+    std::string_view bytes;
+
+    auto &&reader = ProtobufReader(v);
+    while (reader.next(field, wire, value, bytes)) {
+      if (field != FIELD_LIST_VALUE)
+        continue;
+      if (wire == ProtobufReader::WIRE_VARINT) {
+        out = static_cast<Jlong>(value);
+        return true;
+      }
+      if (wire == ProtobufReader::WIRE_LENGTH) {
+        auto &&packed = ProtobufReader(bytes);
+        if (packed.nextVarint(value))
+          out = static_cast<Jlong>(value);
+        return !packed.isError();
+      }
+    }
+    return !reader.isError();
+  }
+
+  Jbool feature(std::string_view key, std::string_view v) {
+    Juint field = 0;
+    Juint wire = 0;
+    uint64_t value = 0;
+    std::string_view bytes;
+    std::vector<std::string_view> list;
+
+    auto &&reader = ProtobufReader(v);
+    while (reader.next(field, wire, value, bytes)) {
+      if (wire != ProtobufReader::WIRE_LENGTH)
+        continue;
+
+      if ((field == FIELD_INT64_LIST) && (key == TFExample::KEY_WIDTH))
+        return int64First(bytes, this->mWidth);
+      if ((field == FIELD_INT64_LIST) && (key == TFExample::KEY_HEIGHT))
+        return int64First(bytes, this->mHeight);
+      if ((field == FIELD_FLOAT_LIST) && (key == TFExample::KEY_XMIN))
+        return floatList(bytes, this->mXmin);
+      if ((field == FIELD_FLOAT_LIST) && (key == TFExample::KEY_XMAX))
+        return floatList(bytes, this->mXmax);
+      if ((field == FIELD_FLOAT_LIST) && (key == TFExample::KEY_YMIN))
+        return floatList(bytes, this->mYmin);
+      if ((field == FIELD_FLOAT_LIST) && (key == TFExample::KEY_YMAX))
+        return floatList(bytes, this->mYmax);
+      if ((field == FIELD_BYTES_LIST) && (key == TFExample::KEY_TEXT))
+        return bytesList(bytes, this->mTexts);
+      if ((field == FIELD_BYTES_LIST) && (key == TFExample::KEY_ENCODED)) {
+        if (!bytesList(bytes, list))
+          return false;
+        for (auto &&one : list)
+          this->mEncoded += one.size();
+        return true;
+      }
+    }
+    return !reader.isError();
+  }
+
+public:
+  TFExampleReader()
+      : mWidth(), mHeight(), mEncoded(), mXmin(), mXmax(), mYmin(), mYmax(), mTexts() {}
+
+  Jbool parse(std::string_view v) {
+    Juint field = 0;
+    Juint wire = 0;
+    uint64_t value = 0;
+    std::string_view features;
+    std::string_view entry;
+    std::string_view bytes;
+
+    this->mWidth = 0;
+    this->mHeight = 0;
+    this->mEncoded = 0;
+    this->mXmin.clear();
+    this->mXmax.clear();
+    this->mYmin.clear();
+    this->mYmax.clear();
+    this->mTexts.clear();
+
+    auto &&example = ProtobufReader(v);
+    while (example.next(field, wire, value, features)) {
+      if (wire != ProtobufReader::WIRE_LENGTH)
+        continue;
+
+      auto &&map = ProtobufReader(features);
+      while (map.next(field, wire, value, entry)) {
+        std::string_view key;
+        std::string_view content;
+
+        if ((field != FIELD_ENTRY) || (wire != ProtobufReader::WIRE_LENGTH))
+          continue;
+
+        auto &&pair = ProtobufReader(entry);
+        while (pair.next(field, wire, value, bytes)) {
+          if (field == FIELD_KEY)
+            key = bytes;
+          else if (field == FIELD_VALUE)
+            content = bytes;
+        }
+        if (pair.isError() || (!this->feature(key, content)))
+          return false;
+      }
+      if (map.isError())
+        return false;
+    }
+    return !example.isError();
+  }
+
+  [[nodiscard]] Jlong getWidth() const { return this->mWidth; }
+
+  [[nodiscard]] Jlong getHeight() const { return this->mHeight; }
+
+  [[nodiscard]] Jsize getEncoded() const { return this->mEncoded; }
+
+  [[nodiscard]] const std::vector<Jfloat> &getXmin() const { return this->mXmin; }
+
+  [[nodiscard]] const std::vector<Jfloat> &getXmax() const { return this->mXmax; }
+
+  [[nodiscard]] const std::vector<Jfloat> &getYmin() const { return this->mYmin; }
+
+  [[nodiscard]] const std::vector<Jfloat> &getYmax() const { return this->mYmax; }
+
+  [[nodiscard]] const std::vector<std::string_view> &getTexts() const { return this->mTexts; }
+};
+
+class TFRecordWriter {
+private:
+  constexpr static Jint SIZE_BUFFER = 4 * 1024 * 1024;
+  constexpr static Jchar MODEL_WRITE[] = "wb";
+
+  FILE *mFile;
+  Jbool mFailed;
+  std::vector<Jchar> mBuffer;
+
+public:
+  explicit TFRecordWriter(const std::string &v) : mFile(), mFailed(), mBuffer(SIZE_BUFFER) {
+    this->mFile = fopen(v.c_str(), MODEL_WRITE);
+    if (this->mFile != nullptr)
+      setvbuf(this->mFile, this->mBuffer.data(), _IOFBF, this->mBuffer.size());
+  }
+
+  ~TFRecordWriter() { this->close(); }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFile != nullptr); }
+
+  // False when any write or the final flush failed, e.g. on a full disk.
+  Jbool close() {
+    if (this->mFile == nullptr)
+      return !this->mFailed;
+
+    this->mFailed = (fclose(this->mFile) != 0) || this->mFailed;
+    this->mFile = nullptr;
+    return !this->mFailed;
+  }
+
+  void write(const std::string &v) {
+    Jbyte header[sizeof(uint64_t) + sizeof(Juint)];
+    Juint footer = 0;
+    uint64_t length = v.size();
+
+    if (this->mFile == nullptr)
+      return;
+
+    memcpy(header, &length, sizeof(length));
+    auto &&lengthCRC = CRC32C::mask(CRC32C::value(header, sizeof(length)));
+    memcpy(&header[sizeof(length)], &lengthCRC, sizeof(lengthCRC));
+    footer = CRC32C::mask(CRC32C::value(v.data(), v.size()));
+
+    if ((fwrite(header, sizeof(header), 1, this->mFile) != 1) ||
+        (!v.empty() && (fwrite(v.data(), v.size(), 1, this->mFile) != 1)) ||
+        (fwrite(&footer, sizeof(footer), 1, this->mFile) != 1))
+      this->mFailed = true;
+  }
+};
+
+class TFRecordSample {
+public:
+  std::string mImagePath;
+  std::string mFilename;
+
+  Jint mWidth;
+  Jint mHeight;
+
+  std::vector<std::string> mNames;
+  std::vector<LabelImageXMLBndbox> mBndboxes;
+
+  TFRecordSample() : mImagePath(), mFilename(), mWidth(), mHeight(), mNames(), mBndboxes() {}
+};
+
+class TFRecordIndex {
+public:
+  Jsize mFile;
+  Jsize mOffset;
+  Jsize mLength;
+
+  TFRecordIndex(Jsize file, Jsize offset, Jsize length)
+      : mFile(file), mOffset(offset), mLength(length) {}
+};
+
+class TFRecordLabel {
+public:
+  Jlong mCount;
+  Jfloat mMin[4];
+  Jfloat mMax[4];
+
+  TFRecordLabel() : mCount(), mMin(), mMax() {
+    std::fill(std::begin(this->mMin), std::end(this->mMin), 1.0f);
+    std::fill(std::begin(this->mMax), std::end(this->mMax), 0.0f);
+  }
+
+  void add(const Jfloat (&v)[4]) {
+    Jint i = 0;
+
+    ++this->mCount;
+    for (i = 0; i < 4; ++i) {
+      this->mMin[i] = std::min(this->mMin[i], v[i]);
+      this->mMax[i] = std::max(this->mMax[i], v[i]);
+    }
+  }
+
+  void merge(const TFRecordLabel &v) {
+    Jint i = 0;
+
+    this->mCount += v.mCount;
+    for (i = 0; i < 4; ++i) {
+      this->mMin[i] = std::min(this->mMin[i], v.mMin[i]);
+      this->mMax[i] = std::max(this->mMax[i], v.mMax[i]);
+    }
+  }
+};
+
+class TFRecordStatistics {
+public:
+  Jlong mRecords;
+  Jlong mBytes;
+  Jlong mCorrupted;
+  std::map<std::string, TFRecordLabel> mLabels;
+
+  TFRecordStatistics() : mRecords(), mBytes(), mCorrupted(), mLabels() {}
+
+  void merge(const TFRecordStatistics &v) {
+    this->mRecords += v.mRecords;
+    this->mBytes += v.mBytes;
+    this->mCorrupted += v.mCorrupted;
+    for (auto &&kv : v.mLabels)
+      this->mLabels[kv.first].merge(kv.second);
+  }
+};
+
+class TensorflowRecord : public AbstractCommand {
+private:
+  constexpr static Jint SIZE_SHARDS = 99999;
+
+  constexpr static Jchar SURRFIX[] = ".xml";
+  constexpr static Jchar OPTION_SHARDS[] = "shards";
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+
+  constexpr static Jchar FORMAT_JPEG[] = "jpeg";
+  constexpr static Jchar FORMAT_PNG[] = "png";
+
+  constexpr static Jchar FORMAT_SHARD[] = "%s-%05d-of-%05d";
+  constexpr static Jchar FORMAT_LABEL_MAP[] = "%s.pbtxt";
+  constexpr static Jchar FORMAT_LABEL_ITEM[] = "item {\n  id: %d\n  name: '%s'\n}\n";
+  constexpr static Jchar FORMAT_MISSING[] = "file: %s, image not found: %s";
+  constexpr static Jchar FORMAT_FAILED[] = "file: %s, write failed";
+  constexpr static Jchar FORMAT_SIZE[] = "file: %s, image size unknown: %s";
+  constexpr static Jchar FORMAT_DONE[] = "records: %d, shards: %d, labels: %d";
+
+  static std::string getFormat(const std::string &v) {
+    auto &&exte = std::filesystem::path(v).extension().string();
+    for (auto &&c : exte)
+      c = static_cast<Jchar>(tolower(c));
+    return (exte == ".png") ? FORMAT_PNG : FORMAT_JPEG;
+  }
+
+  static Jbool writeLabelMap(const std::map<std::string, Jint> &labels, const std::string &out) {
+    Jbool ret = true;
+
+    auto &&name = String::format(FORMAT_LABEL_MAP, out.c_str());
+    auto &&file = fopen(name.c_str(), "wb");
+    if (file == nullptr) {
+      Log::error(FORMAT_FAILED, name.c_str());
+      return false;
+    }
+
+    for (auto &&kv : labels) {
+      auto &&item = String::format(FORMAT_LABEL_ITEM, kv.second, kv.first.c_str());
+      ret = (fwrite(item.data(), item.size(), 1, file) == 1) && ret;
+    }
+    ret = (fclose(file) == 0) && ret;
+    if (!ret)
+      Log::error(FORMAT_FAILED, name.c_str());
+    return ret;
+  }
+
+  static void encode(TFExample &example, const TFRecordSample &sample, const std::string &image,
+                     const std::map<std::string, Jint> &labels) {
+    std::vector<Jfloat> xmin;
+    std::vector<Jfloat> xmax;
+    std::vector<Jfloat> ymin;
+    std::vector<Jfloat> ymax;
+    std::vector<Jlong> ids;
+
+    auto &&width = static_cast<Jfloat>(sample.mWidth);
+    auto &&height = static_cast<Jfloat>(sample.mHeight);
+
+    for (auto &&box : sample.mBndboxes) {
+      xmin.push_back(static_cast<Jfloat>(box.getMinX()) / width);
+      xmax.push_back(static_cast<Jfloat>(box.getMaxX()) / width);
+      ymin.push_back(static_cast<Jfloat>(box.getMinY()) / height);
+      ymax.push_back(static_cast<Jfloat>(box.getMaxY()) / height);
+    }
+    for (auto &&name : sample.mNames)
+      ids.push_back(labels.at(name));
+
+    example.clean();
+    example.addInt64(TFExample::KEY_HEIGHT, sample.mHeight);
+    example.addInt64(TFExample::KEY_WIDTH, sample.mWidth);
+    example.addBytes(TFExample::KEY_FILENAME, sample.mFilename);
+    example.addBytes(TFExample::KEY_SOURCE_ID, sample.mFilename);
+    example.addBytes(TFExample::KEY_ENCODED, image);
+    example.addBytes(TFExample::KEY_FORMAT, getFormat(sample.mImagePath));
+    example.addFloatList(TFExample::KEY_XMIN, xmin);
+    example.addFloatList(TFExample::KEY_XMAX, xmax);
+    example.addFloatList(TFExample::KEY_YMIN, ymin);
+    example.addFloatList(TFExample::KEY_YMAX, ymax);
+    example.addBytesList(TFExample::KEY_TEXT, sample.mNames);
+    example.addInt64List(TFExample::KEY_LABEL, ids);
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jint id = 0;
+    Jint shards = 1;
+    std::atomic<Jint> records(0);
+    std::map<std::string, Jint> labels;
+
+    UP<File> file(new File());
+
+    if (v->getLength() < 2)
+      return -1;
+
+    auto &&in = (*v)[0];
+    auto &&out = std::string((*v)[1]);
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    if (v->getOption(OPTION_SHARDS) != nullptr) {
+      Jchar *end = nullptr;
+      auto &&value = std::strtol(v->getOption(OPTION_SHARDS), &end, 10);
+      if ((end == v->getOption(OPTION_SHARDS)) || (*end != 0x00) || (value < 1) ||
+          (value > SIZE_SHARDS))
+        return -1;
+      shards = static_cast<Jint>(value);
+    }
+
+    if (File::isFile(in))
+      return -1;
+
+    auto &&list = file->getFilesInDirectory<SURRFIX>(in);
+    auto &&files = std::vector<FileAttributes *>();
+    for (auto &&one : list)
+      files.push_back(one.get());
+
+    auto &&samples = std::vector<TFRecordSample>(files.size());
+    auto &&probes = std::vector<ImageProbe>(threads);
+    Parallel::forEach(threads, files.size(), [&files, &samples, &probes](Jsize i, Jint worker) {
+      auto &&xml = LabelImageXML(files[i]->getAbstractPath());
+      auto &&sample = samples[i];
+
+      sample.mImagePath = LabelImageXMLImage::getPath(files[i]->getAbstractPath(), xml);
+      sample.mFilename = xml.getFilename();
+      sample.mWidth = xml.getSize().getWidth();
+      sample.mHeight = xml.getSize().getHeight();
+      // Boxes are normalized by the size, so fall back to the image header when the XML has none.
+      if ((sample.mWidth <= 0) || (sample.mHeight <= 0)) {
+        Jint width = 0;
+        Jint height = 0;
+        if (probes[worker].probe(sample.mImagePath, width, height)) {
+          sample.mWidth = width;
+          sample.mHeight = height;
+        }
+      }
+      for (auto &&object : xml.getObjects()) {
+        sample.mNames.push_back(object.getName());
+        sample.mBndboxes.push_back(object.getBndbox());
+      }
+    });
+
+    for (auto &&sample : samples) {
+      for (auto &&name : sample.mNames)
+        labels.emplace(name, 0);
+    }
+    for (auto &&kv : labels)
+      kv.second = ++id;
+    if (!writeLabelMap(labels, out))
+      return -1;
+
+    auto &&failed = std::vector<Jbyte>(shards);
+    auto &&prog = Program(samples.size());
+    Parallel::forEach(threads, shards, [&](Jsize shard, Jint) {
+      std::string image;
+      TFExample example;
+
+      auto &&name = String::format(FORMAT_SHARD, out.c_str(), static_cast<Jint>(shard), shards);
+      auto &&writer = TFRecordWriter(name);
+      if (!writer.isOpen()) {
+        Log::error(FORMAT_FAILED, name.c_str());
+        failed[shard] = 1;
+        return;
+      }
+
+      for (auto i = shard; i < samples.size(); i += shards) {
+        auto &&sample = samples[i];
+        prog.updateOne();
+
+        if (!File::read(sample.mImagePath, image)) {
+          Log::error(FORMAT_MISSING, files[i]->getName().c_str(), sample.mImagePath.c_str());
+          continue;
+        }
+        if ((sample.mWidth <= 0) || (sample.mHeight <= 0)) {
+          Log::error(FORMAT_SIZE, files[i]->getName().c_str(), sample.mImagePath.c_str());
+          continue;
+        }
+
+        encode(example, sample, image, labels);
+        writer.write(example.getContent());
+        ++records;
+      }
+      if (!writer.close()) {
+        Log::error(FORMAT_FAILED, name.c_str());
+        failed[shard] = 1;
+      }
+    });
+
+    Log::info(FORMAT_DONE, records.load(), shards, static_cast<Jint>(labels.size()));
+    return (std::find(failed.begin(), failed.end(), 1) == failed.end()) ? 0 : -1;
+  }
+};
+
+class TensorflowRecordCheck : public AbstractCommand {
+private:
+  constexpr static Jint SIZE_CHUNK = 64;
+  constexpr static Jsize SIZE_HEADER = sizeof(uint64_t) + sizeof(Juint);
+  constexpr static Jsize SIZE_FOOTER = sizeof(Juint);
+
+  constexpr static Jchar OPTION_THREADS[] = "threads";
+  constexpr static Jchar PATTERN_SHARD[] = "-#####-of-#####";
+  constexpr static const Jchar *SUFFIX_RECORD[] = {".record", ".tfrecord"};
+
+  constexpr static Jchar FORMAT_OPEN[] = "file: %s, open failed";
+  constexpr static Jchar FORMAT_LENGTH[] = "file: %s, offset: %zu, length crc mismatch";
+  constexpr static Jchar FORMAT_TRUNCATED[] = "file: %s, offset: %zu, record truncated";
+  constexpr static Jchar FORMAT_DATA[] = "file: %s, offset: %zu, data crc mismatch";
+  constexpr static Jchar FORMAT_DECODE[] = "file: %s, offset: %zu, example decode failed";
+  constexpr static Jchar FORMAT_COUNT[] = "label: %s-%s-%lld";
+  constexpr static Jchar FORMAT_RANGE[] = "label: %s-%s-[%.4f, %.4f]";
+  constexpr static Jchar FORMAT_DONE[] = "files: %d, records: %lld, bytes: %lld, corrupted: %lld";
+
+  constexpr static Jchar MARK_COUNT[] = "count";
+  constexpr static const Jchar *MARK_RANGE[] = {"xmin", "ymin", "xmax", "ymax"};
+
+  // Shards written by tfrecord, or files named like records; label maps and strays are not.
+  static Jbool isRecord(const std::filesystem::path &v) {
+    auto &&name = v.filename().string();
+    auto &&size = sizeof(PATTERN_SHARD) - 1;
+    for (auto &&one : SUFFIX_RECORD) {
+      if (v.extension() == one)
+        return true;
+    }
+    if (name.size() <= size)
+      return false;
+
+    auto &&tail = std::string_view(name).substr(name.size() - size);
+    for (Jsize i = 0; i < size; ++i) {
+      auto &&match = (PATTERN_SHARD[i] == '#') ? (isdigit(static_cast<Jbyte>(tail[i])) != 0)
+                                                : (tail[i] == PATTERN_SHARD[i]);
+      if (!match)
+        return false;
+    }
+    return true;
+  }
+
+  static std::vector<std::string> getFiles(const std::string &v) {
+    std::vector<std::string> ret;
+
+    if (File::isExist(v) && File::isFile(v))
+      return {v};
+
+    auto &&path = std::filesystem::path(v);
+    auto &&dir = File::isExist(v) ? path : path.parent_path();
+    auto &&prefix = File::isExist(v) ? std::string() : path.filename().string() + "-";
+    if (dir.empty())
+      dir = ".";
+    if (!File::isExist(dir.string()))
+      return ret;
+
+    for (auto &&entry : std::filesystem::directory_iterator(dir)) {
+      auto &&name = entry.path().filename().string();
+      if (entry.is_directory() || !isRecord(entry.path()))
+        continue;
+      if (name.compare(0, prefix.size(), prefix) == 0)
+        ret.push_back(entry.path().string());
+    }
+
+    std::sort(ret.begin(), ret.end());
+    return ret;
+  }
+
+  static Jbool index(const std::string &name, const MappedFile &file,
+                     std::vector<TFRecordIndex> &out, Jsize id) {
+    Jsize offset = 0;
+    uint64_t length = 0;
+    Juint crc = 0;
+
+    auto &&data = file.getData();
+    auto &&size = file.getSize();
+
+    while (offset < size) {
+      if ((size - offset) < SIZE_HEADER) {
+        Log::error(FORMAT_TRUNCATED, name.c_str(), offset);
+        return false;
+      }
+
+      memcpy(&length, &data[offset], sizeof(length));
+      memcpy(&crc, &data[offset + sizeof(length)], sizeof(crc));
+      if (CRC32C::mask(CRC32C::value(&data[offset], sizeof(length))) != crc) {
+        Log::error(FORMAT_LENGTH, name.c_str(), offset);
+        return false;
+      }
+      if ((size - offset - SIZE_HEADER) < (length + SIZE_FOOTER)) {
+        Log::error(FORMAT_TRUNCATED, name.c_str(), offset);
+        return false;
+      }
+
+      out.emplace_back(id, offset, length);
+      offset += SIZE_HEADER + length + SIZE_FOOTER;
+    }
+    return true;
+  }
+
+  static void verify(const std::string &name, const MappedFile &file, const TFRecordIndex &record,
+                     TFExampleReader &reader, TFRecordStatistics &stat) {
+    Jsize i = 0;
+    Juint crc = 0;
+    Jfloat box[4];
+
+    auto &&data = &file.getData()[record.mOffset + SIZE_HEADER];
+    memcpy(&crc, &data[record.mLength], sizeof(crc));
+
+    ++stat.mRecords;
+    stat.mBytes += static_cast<Jlong>(SIZE_HEADER + record.mLength + SIZE_FOOTER);
+    if (CRC32C::mask(CRC32C::value(data, record.mLength)) != crc) {
+      ++stat.mCorrupted;
+      Log::error(FORMAT_DATA, name.c_str(), record.mOffset);
+      return;
+    }
+
+    if (!reader.parse(std::string_view(reinterpret_cast<const Jchar *>(data), record.mLength))) {
+      ++stat.mCorrupted;
+      Log::error(FORMAT_DECODE, name.c_str(), record.mOffset);
+      return;
+    }
+
+    auto &&count = std::min({reader.getTexts().size(), reader.getXmin().size(),
+                             reader.getYmin().size(), reader.getXmax().size(),
+                             reader.getYmax().size()});
+    for (i = 0; i < count; ++i) {
+      box[0] = reader.getXmin()[i];
+      box[1] = reader.getYmin()[i];
+      box[2] = reader.getXmax()[i];
+      box[3] = reader.getYmax()[i];
+      stat.mLabels[std::string(reader.getTexts()[i])].add(box);
+    }
+  }
+
+public:
+  using AbstractCommand::AbstractCommand;
+
+  Jint execute(const UP<ICommandArgs> &v) override {
+    Jint i = 0;
+    std::vector<TFRecordIndex> records;
+    TFRecordStatistics all;
+
+    if (v->getLength() < 1)
+      return -1;
+
+    auto &&threads = Parallel::getConcurrency(v->getOption(OPTION_THREADS));
+    auto &&names = getFiles((*v)[0]);
+    if (names.empty())
+      return -1;
+
+    auto &&files = std::vector<UP<MappedFile>>();
+    auto &&indexes = std::vector<std::vector<TFRecordIndex>>(names.size());
+    for (auto &&name : names)
+      files.emplace_back(new MappedFile(name));
+
+    auto &&stats = std::vector<TFRecordStatistics>(threads);
+    // A shard that cannot be opened counts as corrupted, like one that cannot be framed.
+    Parallel::forEach(threads, files.size(), [&](Jsize id, Jint worker) {
+      if (!files[id]->isOpen()) {
+        Log::error(FORMAT_OPEN, names[id].c_str());
+        ++stats[worker].mCorrupted;
+        return;
+      }
+      files[id]->advise(MADV_SEQUENTIAL);
+      if (!index(names[id], *files[id], indexes[id], id))
+        ++stats[worker].mCorrupted;
+    });
+    for (auto &&one : indexes)
+      records.insert(records.end(), one.begin(), one.end());
+
+    auto &&readers = std::vector<TFExampleReader>(threads);
+    auto &&chunks = (records.size() + SIZE_CHUNK - 1) / SIZE_CHUNK;
+    auto &&prog = Program(chunks);
+    Parallel::forEach(threads, chunks, [&](Jsize chunk, Jint worker) {
+      auto end = std::min(records.size(), (chunk + 1) * SIZE_CHUNK);
+      for (auto j = chunk * SIZE_CHUNK; j < end; ++j) {
+        auto &&record = records[j];
+        verify(names[record.mFile], *files[record.mFile], record, readers[worker],
+               stats[worker]);
+      }
+      prog.updateOne();
+    });
+
+    for (auto &&stat : stats)
+      all.merge(stat);
+
+    for (auto &&kv : all.mLabels) {
+      Log::info(FORMAT_COUNT, kv.first.c_str(), MARK_COUNT, kv.second.mCount);
+      for (i = 0; i < 4; ++i)
+        Log::info(FORMAT_RANGE, kv.first.c_str(), MARK_RANGE[i], kv.second.mMin[i],
+                  kv.second.mMax[i]);
+    }
+    Log::info(FORMAT_DONE, static_cast<Jint>(names.size()), all.mRecords, all.mBytes,
+              all.mCorrupted);
+    return (all.mCorrupted == 0) ? 0 : -1;
+  }
+};
+
+} // namespace tfutils
+
+#endif // TFUTILS_TF_COMMAND_TENSORFLOW_RECORD_HPP
@@ -28,10 +28,8 @@ private:
   String() : mBuffer() {}
 
   static String &getInstance() {
-    static String *obj = nullptr;
-    if (obj == nullptr)
-      obj = new String();
-    return (*obj);
+    static thread_local String obj;
+    return obj;
   }
 
   template <class... Args> std::string input(const std::string &format, Args... args) {
@@ -60,10 +58,8 @@ private:
   Log() : mBuffer() {}
 
   static Log &getInstance() {
-    static Log *obj = nullptr;
-    if (obj == nullptr)
-      obj = new Log();
-    return (*obj);
+    static thread_local Log obj;
+    return obj;
   }
 
   template <class... Args> std::string format(const std::string &format, Args... args) {
@@ -118,6 +114,7 @@ private:
 
   Jint mAll;
   Jint mCurrent;
+  std::mutex mMutex;
 
   static void format(Jfloat all, Jfloat current) {
     Jint i = 0;
@@ -138,11 +135,272 @@ private:
   }
 
 public:
-  explicit Program(Jint v) : mAll(v), mCurrent() {}
+  explicit Program(Jint v) : mAll(v), mCurrent(), mMutex() {}
 
-  void updateOne() { Program::format(this->mAll, (++this->mCurrent)); }
+  void updateOne() {
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    Program::format(this->mAll, (++this->mCurrent));
+  }
+
+  void update(Jint v) {
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    Program::format(this->mAll, (this->mCurrent += v));
+  }
+};
+
+class Parallel {
+public:
+  static Jint getConcurrency(const Jchar *v = nullptr) {
+    if (v != nullptr) {
+      auto &&ret = std::strtol(v, nullptr, 10);
+      if (ret > 0)
+        return static_cast<Jint>(ret);
+    }
+
+    auto &&ret = static_cast<Jint>(std::thread::hardware_concurrency());
+    return (ret > 0) ? ret : 1;
+  }
+
+  template <class Fun> static void forEach(Jint threads, Jsize count, Fun &&fun) {
+    Jint i = 0;
+    std::atomic<Jsize> next(0);
+    std::vector<std::thread> workers;
+
+    if (count == 0)
+      return;
+    if (threads < 1)
+      threads = 1;
+    if (static_cast<Jsize>(threads) > count)
+      threads = static_cast<Jint>(count);
+
+    auto &&loop = [&next, &fun, count](Jint worker) {
+      for (auto index = next++; index < count; index = next++)
+        fun(index, worker);
+    };
+
+    for (i = 1; i < threads; ++i)
+      workers.emplace_back(loop, i);
+    loop(0);
+
+    for (auto &&worker : workers)
+      worker.join();
+  }
+};
+
+class CRC32C {
+private:
+  constexpr static Juint POLY = 0x82f63b78;
+  constexpr static Juint MASK_DELTA = 0xa282ead8;
+
+  Juint mTable[256];
+
+  CRC32C() : mTable() {
+    Juint i = 0;
+    Juint j = 0;
+
+    for (i = 0; i < 256; ++i) {
+      auto crc = i;
+      for (j = 0; j < 8; ++j)
+        crc = (crc & 1u) ? ((crc >> 1u) ^ POLY) : (crc >> 1u);
+      this->mTable[i] = crc;
+    }
+  }
+
+  static CRC32C &getInstance() {
+    static CRC32C obj;
+    return obj;
+  }
+
+  Juint software(Juint crc, const Jbyte *v, Jsize len) {
+    while (len-- > 0)
+      crc = this->mTable[(crc ^ *v++) & 0xffu] ^ (crc >> 8u);
+    return crc;
+  }
+
+#if defined(__x86_64__)
+  __attribute__((target("sse4.2"))) static Juint hardware(Juint crc, const Jbyte *v, Jsize len) {
+    uint64_t crc64 = crc;
+    uint64_t word = 0;
+
+    while ((len > 0) && ((reinterpret_cast<uintptr_t>(v) & 7u) != 0)) {
+      crc64 = __builtin_ia32_crc32qi(static_cast<Juint>(crc64), *v++);
+      --len;
+    }
+    while (len >= 8) {
+      memcpy(&word, v, sizeof(word));
+      crc64 = __builtin_ia32_crc32di(crc64, word);
+      v += 8;
+      len -= 8;
+    }
+    while (len-- > 0)
+      crc64 = __builtin_ia32_crc32qi(static_cast<Juint>(crc64), *v++);
+    return static_cast<Juint>(crc64);
+  }
+
+  static Jbool isHardware() {
+    static const Jbool ret = __builtin_cpu_supports("sse4.2");
+    return ret;
+  }
+#endif
+
+public:
+  static Juint value(const void *v, Jsize len) {
+    auto &&data = static_cast<const Jbyte *>(v);
+#if defined(__x86_64__)
+    if (isHardware())
+      return ~hardware(~0u, data, len);
+#endif
+    return ~CRC32C::getInstance().software(~0u, data, len);
+  }
+
+  static Juint mask(Juint crc) { return ((crc >> 15u) | (crc << 17u)) + MASK_DELTA; }
+
+  static Juint unmask(Juint v) {
+    auto &&rot = v - MASK_DELTA;
+    return ((rot >> 17u) | (rot << 15u));
+  }
+};
+
+class Hash64 {
+private:
+  constexpr static uint64_t PRIME_1 = 0x9e3779b185ebca87ull;
+  constexpr static uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4full;
+  constexpr static uint64_t PRIME_3 = 0x165667b19e3779f9ull;
+  constexpr static uint64_t PRIME_4 = 0x85ebca77c2b2ae63ull;
+  constexpr static uint64_t PRIME_5 = 0x27d4eb2f165667c5ull;
+  constexpr static Jsize SIZE_STRIPE = 32;
+
+  uint64_t mSeed;
+  uint64_t mLanes[4];
+  uint64_t mTotal;
+  Jbyte mStripe[SIZE_STRIPE];
+  Jsize mStripeLength;
+
+  static uint64_t rotate(uint64_t v, Juint r) { return (v << r) | (v >> (64u - r)); }
+
+  static uint64_t load64(const Jbyte *v) {
+    uint64_t ret = 0;
+    memcpy(&ret, v, sizeof(ret));
+    return ret;
+  }
+
+  static uint64_t load32(const Jbyte *v) {
+    Juint ret = 0;
+    memcpy(&ret, v, sizeof(ret));
+    return ret;
+  }
+
+  static uint64_t round(uint64_t acc, uint64_t v) {
+    acc += v * PRIME_2;
+    return rotate(acc, 31) * PRIME_1;
+  }
+
+  static uint64_t merge(uint64_t acc, uint64_t v) {
+    acc ^= round(0, v);
+    return acc * PRIME_1 + PRIME_4;
+  }
 
-  void update(Jint v) { Program::format(this->mAll, (this->mCurrent += v)); }
+  void stripes(const Jbyte *v, Jsize count) {
+    auto lane0 = this->mLanes[0];
+    auto lane1 = this->mLanes[1];
+    auto lane2 = this->mLanes[2];
+    auto lane3 = this->mLanes[3];
+
+    while (count-- > 0) {
+      lane0 = round(lane0, load64(v));
+      lane1 = round(lane1, load64(v + 8));
+      lane2 = round(lane2, load64(v + 16));
+      lane3 = round(lane3, load64(v + 24));
+      v += SIZE_STRIPE;
+    }
+
+    this->mLanes[0] = lane0;
+    this->mLanes[1] = lane1;
+    this->mLanes[2] = lane2;
+    this->mLanes[3] = lane3;
+  }
+
+public:
+  explicit Hash64(uint64_t seed = 0)
+      : mSeed(seed), mLanes(), mTotal(), mStripe(), mStripeLength() {
+    this->reset();
+  }
+
+  void reset() {
+    this->mLanes[0] = this->mSeed + PRIME_1 + PRIME_2;
+    this->mLanes[1] = this->mSeed + PRIME_2;
+    this->mLanes[2] = this->mSeed;
+    this->mLanes[3] = this->mSeed - PRIME_1;
+    this->mTotal = 0;
+    this->mStripeLength = 0;
+  }
+
+  void update(const void *v, Jsize len) {
+    auto &&data = static_cast<const Jbyte *>(v);
+
+    this->mTotal += len;
+    if (this->mStripeLength > 0) {
+      auto fill = std::min(len, SIZE_STRIPE - this->mStripeLength);
+      memcpy(&this->mStripe[this->mStripeLength], data, fill);
+      this->mStripeLength += fill;
+      data += fill;
+      len -= fill;
+      if (this->mStripeLength < SIZE_STRIPE)
+        return;
+      this->stripes(this->mStripe, 1);
+      this->mStripeLength = 0;
+    }
+
+    this->stripes(data, len / SIZE_STRIPE);
+    data += (len / SIZE_STRIPE) * SIZE_STRIPE;
+    len %= SIZE_STRIPE;
+
+    memcpy(this->mStripe, data, len);
+    this->mStripeLength = len;
+  }
+
+  [[nodiscard]] uint64_t digest() const {
+    uint64_t ret = 0;
+    Jsize i = 0;
+
+    if (this->mTotal >= SIZE_STRIPE) {
+      ret = rotate(this->mLanes[0], 1) + rotate(this->mLanes[1], 7) +
+            rotate(this->mLanes[2], 12) + rotate(this->mLanes[3], 18);
+      ret = merge(ret, this->mLanes[0]);
+      ret = merge(ret, this->mLanes[1]);
+      ret = merge(ret, this->mLanes[2]);
+      ret = merge(ret, this->mLanes[3]);
+    } else {
+      ret = this->mSeed + PRIME_5;
+    }
+    ret += this->mTotal;
+
+    for (; (i + 8) <= this->mStripeLength; i += 8) {
+      ret ^= round(0, load64(&this->mStripe[i]));
+      ret = rotate(ret, 27) * PRIME_1 + PRIME_4;
+    }
+    for (; (i + 4) <= this->mStripeLength; i += 4) {
+      ret ^= load32(&this->mStripe[i]) * PRIME_1;
+      ret = rotate(ret, 23) * PRIME_2 + PRIME_3;
+    }
+    for (; i < this->mStripeLength; ++i) {
+      ret ^= this->mStripe[i] * PRIME_5;
+      ret = rotate(ret, 11) * PRIME_1;
+    }
+
+    ret ^= ret >> 33u;
+    ret *= PRIME_2;
+    ret ^= ret >> 29u;
+    ret *= PRIME_3;
+    ret ^= ret >> 32u;
+    return ret;
+  }
+
+  static uint64_t value(const void *v, Jsize len, uint64_t seed = 0) {
+    Hash64 hash(seed);
+    hash.update(v, len);
+    return hash.digest();
+  }
 };
 
 class SystemRow {
@@ -155,50 +413,270 @@ public:
   std::string const &getRow() { return this->mRow; }
 };
 
-class System {
+// Runs queued commands through posix_spawnp, at most mConcurrency children at once. Each
+// child's stdout and stderr come back through pipes multiplexed with epoll and are handed
+// to the caller line by line as they arrive.
+class ProcessPool {
 private:
-  constexpr static Jint SIZE_CACHE = 1024;
+  constexpr static Jint SIZE_READ = 64 * 1024;
+  constexpr static Jint SIZE_EVENTS = 64;
+  constexpr static Jint WAIT_REAP = 20;
+  constexpr static Jint STATUS_FAILED = -1;
+
+  constexpr static Jchar ASC_CR = '\r';
+  constexpr static Jchar ASC_LF = '\n';
+
+  struct Stream {
+    Jsize mIndex;
+    Jbool mError;
+    std::string mPending;
+  };
+
+  // A child is done once both pipes are closed and it has been reaped; mPidFd turns
+  // readable when it exits, without it reaping is polled.
+  struct Child {
+    pid_t mPid;
+    Jint mOpen;
+    Jint mPidFd;
+    Jbool mExited;
+    Jint mStatus;
+  };
+
+  Jint mConcurrency;
+  std::vector<std::vector<std::string>> mCommands;
+
+  // Never blocks: a child that closed its pipes may still be running.
+  static Jbool reap(Child &child) {
+    Jint value = 0;
+    pid_t ret = 0;
+
+    if (child.mExited)
+      return true;
+    while ((ret = waitpid(child.mPid, &value, WNOHANG)) < 0) {
+      if (errno != EINTR)
+        break;
+    }
+    if (ret == 0)
+      return false;
 
-  constexpr static Jchar ASC_LF = '\r';
-  constexpr static Jchar ASC_CR = '\n';
-  constexpr static Jchar MODEL_READ[] = "r";
+    child.mExited = true;
+    child.mStatus = ((ret > 0) && WIFEXITED(value)) ? WEXITSTATUS(value) : STATUS_FAILED;
+    return true;
+  }
 
-  Jchar mCache[SIZE_CACHE];
-  Jchar mCacheNew[SIZE_CACHE];
-  std::string mCommand;
-  std::list<SystemRow> mRows;
+  // Splits what arrived into lines; carriage returns are dropped like the shell output
+  // they usually come from.
+  template <class Line> static void split(Stream &stream, const Jchar *data, Jsize size,
+                                          Line &&line) {
+    for (Jsize i = 0; i < size; ++i) {
+      if (data[i] == ASC_LF) {
+        line(stream.mIndex, stream.mPending, stream.mError);
+        stream.mPending.clear();
+      } else if (data[i] != ASC_CR) {
+        stream.mPending.push_back(data[i]);
+      }
+    }
+  }
+
+  // Starts command index with both pipes registered on epoll; returns false if it could
+  // not be started.
+  Jbool spawn(Jint epoll, Jsize index, std::map<Jint, Stream> &streams,
+              std::map<Jint, Jsize> &exits, std::map<Jsize, Child> &children) {
+    Jint out[2] = {-1, -1};
+    Jint err[2] = {-1, -1};
+    pid_t pid = 0;
+    posix_spawn_file_actions_t actions;
+    std::vector<Jchar *> argv;
+
+    for (auto &&arg : this->mCommands[index])
+      argv.push_back(const_cast<Jchar *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    if (pipe2(out, O_CLOEXEC) != 0)
+      return false;
+    if (pipe2(err, O_CLOEXEC) != 0) {
+      close(out[0]);
+      close(out[1]);
+      return false;
+    }
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+    auto &&ret = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(out[1]);
+    close(err[1]);
+    if (ret != 0) {
+      close(out[0]);
+      close(err[0]);
+      return false;
+    }
+
+    for (auto &&fd : {out[0], err[0]}) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+      streams[fd] = Stream{index, fd == err[0], std::string()};
+    }
+
+    auto &&pidfd = static_cast<Jint>(syscall(__NR_pidfd_open, pid, 0));
+    if (pidfd >= 0) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = pidfd;
+      epoll_ctl(epoll, EPOLL_CTL_ADD, pidfd, &event);
+      exits[pidfd] = index;
+    }
+    children[index] = Child{pid, 2, pidfd, false, STATUS_FAILED};
+    return true;
+  }
 
 public:
-  explicit System(std::string v) : mCache(), mCacheNew(), mCommand(move(v)), mRows() {}
+  explicit ProcessPool(Jint concurrency)
+      : mConcurrency(std::max(concurrency, 1)), mCommands() {}
 
-  void execute() {
-    Jint i = 0;
-    Jint j = 0;
-    Jint retLen = 0;
+  // Queues argv, argv[0] being looked up in PATH; returns its index.
+  Jsize add(std::vector<std::string> argv) {
+    this->mCommands.push_back(move(argv));
+    return this->mCommands.size() - 1;
+  }
 
-    if (this->mCommand.empty())
+  [[nodiscard]] Jsize getLength() const { return this->mCommands.size(); }
+
+  // Runs every queued command. line(index, row, error) gets each output row, error marking
+  // stderr; done(index, status) follows the last row with the exit code, or -1 when the
+  // command could not be started or was killed. Both are called on this thread.
+  template <class Line, class Done> void execute(Line &&line, Done &&done) {
+    Jsize next = 0;
+    std::map<Jint, Stream> streams;
+    std::map<Jint, Jsize> exits;
+    std::map<Jsize, Child> children;
+    std::vector<Jchar> buffer(SIZE_READ);
+    epoll_event events[SIZE_EVENTS];
+
+    auto &&epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll < 0) {
+      for (Jsize i = 0; i < this->mCommands.size(); ++i)
+        done(i, STATUS_FAILED);
       return;
+    }
 
-    auto &&ctx = popen(this->mCommand.c_str(), MODEL_READ);
+    auto &&finish = [&children, &done](Jsize index) {
+      auto &&child = children[index];
+      if ((child.mOpen > 0) || !child.mExited)
+        return;
+      auto status = child.mStatus;
+      children.erase(index);
+      done(index, status);
+    };
+
+    while ((next < this->mCommands.size()) || !children.empty()) {
+      while ((next < this->mCommands.size()) &&
+             (children.size() < static_cast<Jsize>(this->mConcurrency))) {
+        auto &&index = next++;
+        if (this->mCommands[index].empty() ||
+            !this->spawn(epoll, index, streams, exits, children))
+          done(index, STATUS_FAILED);
+      }
+      if (children.empty())
+        continue;
+
+      // Children without a pidfd that closed their pipes are polled until they exit.
+      auto timeout = -1;
+      for (auto &&kv : children) {
+        if ((kv.second.mOpen == 0) && (kv.second.mPidFd < 0))
+          timeout = WAIT_REAP;
+      }
 
-    do {
-      retLen = fread(this->mCache, 1, sizeof(this->mCache), ctx);
-      for (i = 0; i < retLen; ++i) {
-        if (this->mCache[i] == ASC_CR) {
-          this->mCacheNew[j] = 0x00;
-          j = 0;
-          this->mRows.emplace_back(this->mCacheNew);
-          continue;
-        } else if (this->mCache[i] == ASC_LF) {
+      auto &&count = epoll_wait(epoll, events, SIZE_EVENTS, timeout);
+      for (Jint i = 0; i < count; ++i) {
+        Jint fd = events[i].data.fd;
+        auto &&exit = exits.find(fd);
+        if (exit != exits.end()) {
+          auto index = exit->second;
+          auto &&child = children[index];
+          if (!reap(child))
+            continue;
+          epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+          close(fd);
+          exits.erase(exit);
+          child.mPidFd = -1;
+          finish(index);
           continue;
-        } else {
-          this->mCacheNew[j] = this->mCache[i];
-          ++j;
         }
+
+        auto &&stream = streams[fd];
+        ssize_t retLen = 0;
+
+        while ((retLen = read(fd, buffer.data(), buffer.size())) > 0)
+          split(stream, buffer.data(), retLen, line);
+        if ((retLen < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+          continue;
+
+        // End of stream: a last row without its newline still counts.
+        auto index = stream.mIndex;
+        if (!stream.mPending.empty())
+          line(index, stream.mPending, stream.mError);
+        epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        streams.erase(fd);
+
+        auto &&child = children[index];
+        if ((--child.mOpen == 0) && (child.mPidFd < 0))
+          reap(child);
+        finish(index);
       }
-    } while (retLen == sizeof(this->mCache));
 
-    pclose(ctx);
+      if (timeout < 0)
+        continue;
+      std::vector<Jsize> polled;
+      for (auto &&kv : children) {
+        if ((kv.second.mOpen == 0) && (kv.second.mPidFd < 0) && reap(kv.second))
+          polled.push_back(kv.first);
+      }
+      for (auto &&index : polled)
+        finish(index);
+    }
+    close(epoll);
+  }
+};
+
+class System {
+private:
+  constexpr static Jchar SHELL[] = "/bin/sh";
+  constexpr static Jchar SHELL_COMMAND[] = "-c";
+
+  std::vector<std::string> mCommand;
+  std::list<SystemRow> mRows;
+
+public:
+  // Runs v through the shell, like popen did.
+  explicit System(std::string v) : mCommand(), mRows() {
+    if (!v.empty())
+      this->mCommand = {SHELL, SHELL_COMMAND, move(v)};
+  }
+
+  // Runs argv directly, without a shell in between.
+  explicit System(std::vector<std::string> v) : mCommand(move(v)), mRows() {}
+
+  // Collects stdout as rows; stderr is passed through.
+  void execute() {
+    if (this->mCommand.empty())
+      return;
+
+    ProcessPool pool(1);
+    pool.add(this->mCommand);
+    pool.execute(
+        [this](Jsize, const std::string &row, Jbool error) {
+          if (error)
+            fprintf(stderr, "%s\n", row.c_str());
+          else
+            this->mRows.emplace_back(row.c_str());
+        },
+        [](Jsize, Jint) {});
   }
 
   std::list<SystemRow> const &getRows() { return this->mRows; }
@@ -226,6 +704,695 @@ public:
   std::string const &getAbstractPath() { return this->mFileAbstractPath; }
 };
 
+class MappedFile {
+private:
+  Jint mFd;
+  Jbyte *mData;
+  Jsize mSize;
+
+public:
+  explicit MappedFile(const std::string &v) : mFd(-1), mData(), mSize() {
+    struct stat info = {};
+
+    this->mFd = open(v.c_str(), O_RDONLY);
+    if (this->mFd < 0)
+      return;
+    if ((fstat(this->mFd, &info) != 0) || (info.st_size == 0))
+      return;
+
+    auto &&data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, this->mFd, 0);
+    if (data == MAP_FAILED)
+      return;
+
+    this->mData = static_cast<Jbyte *>(data);
+    this->mSize = info.st_size;
+  }
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (this->mData != nullptr)
+      munmap(this->mData, this->mSize);
+    if (this->mFd >= 0)
+      close(this->mFd);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFd >= 0); }
+
+  [[nodiscard]] const Jbyte *getData() const { return this->mData; }
+
+  [[nodiscard]] Jsize getSize() const { return this->mSize; }
+
+  void advise(Jint v) {
+    if (this->mData != nullptr)
+      madvise(this->mData, this->mSize, v);
+  }
+};
+
+// gzip through zlib. Decompression accepts any number of concatenated members, which is
+// what OutputFile produces.
+class Gzip {
+private:
+  constexpr static Jint WINDOW_GZIP = 15 + 16;
+  constexpr static Jint WINDOW_AUTO = 15 + 32;
+  constexpr static Jint SIZE_MEMORY_LEVEL = 8;
+  constexpr static Jsize SIZE_CHUNK = 1024 * 1024 * 1024;
+  constexpr static Jsize SIZE_INITIAL = 64 * 1024;
+  constexpr static Jchar SURRFIX[] = ".gz";
+
+public:
+  static Jbool isGzip(std::string_view path) {
+    auto &&size = sizeof(SURRFIX) - 1;
+    return (path.size() > size) && (path.substr(path.size() - size) == SURRFIX);
+  }
+
+  // After gzread returned 0: false when the stream ended early or is corrupt, which zlib
+  // reports through gzerror rather than the return value.
+  static Jbool isComplete(gzFile v) {
+    Jint error = Z_OK;
+    gzerror(v, &error);
+    return (error == Z_OK);
+  }
+
+  // a.csv.gz has the extension .csv; any other path keeps its own.
+  static std::filesystem::path getExtension(const std::filesystem::path &v) {
+    return isGzip(v.string()) ? v.stem().extension() : v.extension();
+  }
+
+  // Replaces v with its decompressed content; v is left untouched on failure.
+  static Jbool decompress(std::string &v) {
+    z_stream stream = {};
+    std::string out;
+    Jsize in = 0;
+    Jsize length = 0;
+    Jint ret = Z_OK;
+
+    if (inflateInit2(&stream, WINDOW_AUTO) != Z_OK)
+      return false;
+
+    out.resize(std::max(v.size() * 4, SIZE_INITIAL));
+    while (true) {
+      if ((stream.avail_in == 0) && (in < v.size())) {
+        auto chunk = std::min(v.size() - in, SIZE_CHUNK);
+        stream.next_in = reinterpret_cast<Bytef *>(&v[in]);
+        stream.avail_in = static_cast<uInt>(chunk);
+        in += chunk;
+      }
+      if (length == out.size())
+        out.resize(out.size() * 2);
+
+      auto space = std::min(out.size() - length, SIZE_CHUNK);
+      stream.next_out = reinterpret_cast<Bytef *>(&out[length]);
+      stream.avail_out = static_cast<uInt>(space);
+      ret = inflate(&stream, Z_NO_FLUSH);
+      length += space - stream.avail_out;
+
+      if (ret == Z_STREAM_END) {
+        if ((stream.avail_in == 0) && (in == v.size()))
+          break;
+        ret = inflateReset(&stream);
+      }
+      // No progress with all input consumed means the stream was cut short.
+      if ((ret != Z_OK) && ((ret != Z_BUF_ERROR) || (stream.avail_in == 0 && in == v.size())))
+        break;
+    }
+
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END)
+      return false;
+
+    out.resize(length);
+    v.swap(out);
+    return true;
+  }
+
+  // Appends size bytes of data to out as one complete gzip member.
+  static Jbool compress(const Jchar *data, Jsize size, std::string &out,
+                        Jint level = Z_DEFAULT_COMPRESSION) {
+    z_stream stream = {};
+
+    if (deflateInit2(&stream, level, Z_DEFLATED, WINDOW_GZIP, SIZE_MEMORY_LEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+      return false;
+
+    auto offset = out.size();
+    out.resize(offset + deflateBound(&stream, size));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<Jchar *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef *>(&out[offset]);
+    stream.avail_out = static_cast<uInt>(out.size() - offset);
+
+    auto &&ret = deflate(&stream, Z_FINISH);
+    out.resize(offset + stream.total_out);
+    deflateEnd(&stream);
+    return (ret == Z_STREAM_END);
+  }
+};
+
+// Output written as is, or gzip compressed when asked. Compressed data is cut into
+// SIZE_BLOCK blocks that are deflated threads at a time, each as an independent gzip member,
+// and written in order; the members concatenate into one valid .gz file.
+class OutputFile {
+private:
+  constexpr static Jsize SIZE_BLOCK = 1024 * 1024;
+  constexpr static Jchar MODEL_WRITER_ONLY[] = "wb";
+
+  FILE *mFile;
+  Jint mThreads;
+  Jbool mCompressed;
+  Jbool mFailed;
+  std::string mPending;
+  std::vector<std::string> mBlocks;
+
+  void compress() {
+    auto count = (this->mPending.size() + SIZE_BLOCK - 1) / SIZE_BLOCK;
+    if (count > this->mBlocks.size())
+      this->mBlocks.resize(count);
+
+    // A member is never empty, so an empty block marks a failed one.
+    Parallel::forEach(this->mThreads, count, [this](Jsize i, Jint) {
+      auto begin = i * SIZE_BLOCK;
+      auto size = std::min(SIZE_BLOCK, this->mPending.size() - begin);
+      auto &&block = this->mBlocks[i];
+      block.clear();
+      if (!Gzip::compress(&this->mPending[begin], size, block))
+        block.clear();
+    });
+
+    for (Jsize i = 0; i < count; ++i) {
+      auto &&block = this->mBlocks[i];
+      this->mFailed = block.empty() || this->mFailed ||
+                      (fwrite(block.data(), 1, block.size(), this->mFile) != block.size());
+    }
+    this->mPending.clear();
+  }
+
+public:
+  explicit OutputFile(const std::string &path, Jbool compressed,
+                      const Jchar *mode = MODEL_WRITER_ONLY, Jint threads = 1)
+      : mFile(), mThreads(std::max(threads, 1)), mCompressed(compressed), mFailed(), mPending(),
+        mBlocks() {
+    this->mFile = fopen(path.c_str(), mode);
+    this->mFailed = (this->mFile == nullptr);
+  }
+
+  OutputFile(const OutputFile &) = delete;
+
+  OutputFile &operator=(const OutputFile &) = delete;
+
+  ~OutputFile() { this->close(); }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFile != nullptr); }
+
+  void write(const void *data, Jsize size) {
+    if (this->mFile == nullptr)
+      return;
+    if (!this->mCompressed) {
+      this->mFailed = (fwrite(data, 1, size, this->mFile) != size) || this->mFailed;
+      return;
+    }
+
+    this->mPending.append(static_cast<const Jchar *>(data), size);
+    if (this->mPending.size() >= SIZE_BLOCK * this->mThreads)
+      this->compress();
+  }
+
+  void write(std::string_view v) { this->write(v.data(), v.size()); }
+
+  // Writes out what is pending and closes the file; false if anything failed.
+  Jbool close() {
+    if (this->mFile == nullptr)
+      return !this->mFailed;
+
+    if (this->mCompressed)
+      this->compress();
+    this->mFailed = (fflush(this->mFile) != 0) || this->mFailed;
+    this->mFailed = (fclose(this->mFile) != 0) || this->mFailed;
+    this->mFile = nullptr;
+    return !this->mFailed;
+  }
+};
+
+// Sequential line reader with one reusable buffer; a returned line stays valid until the
+// next call. Line ends ("\n" or "\r\n") are not part of the line. zlib reads plain files as
+// they are and gzip files decompressed.
+class LineReader {
+private:
+  constexpr static Jsize SIZE_DEFAULT = 1024 * 1024;
+  constexpr static Juint SIZE_GZIP_BUFFER = 128 * 1024;
+  constexpr static Jsize SIZE_READ_MAX = 1024 * 1024 * 1024;
+  constexpr static Jchar MODEL_READER_ONLY[] = "rb";
+
+  gzFile mFile;
+  std::vector<Jchar> mBuffer;
+  Jsize mBegin;
+  Jsize mEnd;
+  Jbool mEof;
+  Jbool mFailed;
+
+public:
+  explicit LineReader(const std::string &path, Jsize size = SIZE_DEFAULT)
+      : mFile(), mBuffer(std::max<Jsize>(size, 1)), mBegin(), mEnd(), mEof(), mFailed() {
+    this->mFile = gzopen(path.c_str(), MODEL_READER_ONLY);
+    if (this->mFile != nullptr)
+      gzbuffer(this->mFile, SIZE_GZIP_BUFFER);
+  }
+
+  LineReader(const LineReader &) = delete;
+
+  LineReader &operator=(const LineReader &) = delete;
+
+  ~LineReader() {
+    if (this->mFile != nullptr)
+      gzclose(this->mFile);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFile != nullptr); }
+
+  // True once a read failed, e.g. on a truncated or corrupt .gz file; next() then ends early.
+  [[nodiscard]] Jbool isFailed() const { return this->mFailed; }
+
+  Jbool next(std::string_view &line) {
+    if (this->mFile == nullptr)
+      return false;
+
+    while (true) {
+      auto &&data = this->mBuffer.data();
+      auto &&lf = static_cast<const Jchar *>(
+          memchr(&data[this->mBegin], '\n', this->mEnd - this->mBegin));
+      if ((lf != nullptr) || (this->mEof && (this->mBegin < this->mEnd))) {
+        auto &&stop = (lf == nullptr) ? this->mEnd : static_cast<Jsize>(lf - data);
+        line = std::string_view(&data[this->mBegin], stop - this->mBegin);
+        if (!line.empty() && (line.back() == '\r'))
+          line.remove_suffix(1);
+        this->mBegin = std::min(stop + 1, this->mEnd);
+        return true;
+      }
+      if (this->mEof)
+        return false;
+
+      // Keep the partial line, growing the buffer when one line fills all of it.
+      memmove(data, &data[this->mBegin], this->mEnd - this->mBegin);
+      this->mEnd -= this->mBegin;
+      this->mBegin = 0;
+      if (this->mEnd == this->mBuffer.size())
+        this->mBuffer.resize(this->mBuffer.size() * 2);
+
+      auto want = std::min(this->mBuffer.size() - this->mEnd, SIZE_READ_MAX);
+      auto &&retLen = gzread(this->mFile, &this->mBuffer[this->mEnd], static_cast<Juint>(want));
+      this->mEnd += std::max(retLen, 0);
+      this->mEof = (retLen <= 0);
+      this->mFailed = (retLen < 0) || (this->mEof && !Gzip::isComplete(this->mFile));
+    }
+  }
+};
+
+class IoUring {
+private:
+  Jint mFd;
+  Jsize mRingSize;
+  Jsize mSqeSize;
+  Jbyte *mSqRing;
+  Jbyte *mCqRing;
+  io_uring_sqe *mSqes;
+  io_uring_params mParams;
+  Juint mPending;
+
+  template <class T> [[nodiscard]] T *sq(Juint offset) const {
+    return reinterpret_cast<T *>(this->mSqRing + offset);
+  }
+
+  template <class T> [[nodiscard]] T *cq(Juint offset) const {
+    return reinterpret_cast<T *>(this->mCqRing + offset);
+  }
+
+public:
+  explicit IoUring(Juint v)
+      : mFd(-1), mRingSize(), mSqeSize(), mSqRing(), mCqRing(), mSqes(), mParams(), mPending() {
+    this->mFd = static_cast<Jint>(syscall(__NR_io_uring_setup, v, &this->mParams));
+    if (this->mFd < 0)
+      return;
+
+    auto &&sqSize = this->mParams.sq_off.array + this->mParams.sq_entries * sizeof(Juint);
+    auto &&cqSize = this->mParams.cq_off.cqes + this->mParams.cq_entries * sizeof(io_uring_cqe);
+    this->mRingSize = std::max<Jsize>(sqSize, cqSize);
+    this->mSqeSize = this->mParams.sq_entries * sizeof(io_uring_sqe);
+
+    // Kernels without a single ring mapping are treated as unsupported.
+    if ((this->mParams.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+      this->release();
+      return;
+    }
+
+    auto &&ring = mmap(nullptr, this->mRingSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, this->mFd, IORING_OFF_SQ_RING);
+    auto &&sqes = mmap(nullptr, this->mSqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       this->mFd, IORING_OFF_SQES);
+    this->mSqRing = (ring == MAP_FAILED) ? nullptr : static_cast<Jbyte *>(ring);
+    this->mCqRing = this->mSqRing;
+    this->mSqes = (sqes == MAP_FAILED) ? nullptr : static_cast<io_uring_sqe *>(sqes);
+    if ((this->mSqRing == nullptr) || (this->mSqes == nullptr))
+      this->release();
+  }
+
+  IoUring(const IoUring &) = delete;
+
+  IoUring &operator=(const IoUring &) = delete;
+
+  ~IoUring() { this->release(); }
+
+  void release() {
+    if (this->mSqes != nullptr)
+      munmap(this->mSqes, this->mSqeSize);
+    if (this->mSqRing != nullptr)
+      munmap(this->mSqRing, this->mRingSize);
+    if (this->mFd >= 0)
+      close(this->mFd);
+    this->mFd = -1;
+    this->mSqRing = nullptr;
+    this->mCqRing = nullptr;
+    this->mSqes = nullptr;
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFd >= 0); }
+
+  [[nodiscard]] Jbool isSupported(std::initializer_list<Jint> v) const {
+    constexpr Jsize SIZE_OPS = 256;
+
+    std::vector<Jbyte> buffer(sizeof(io_uring_probe) + SIZE_OPS * sizeof(io_uring_probe_op));
+    auto &&probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (syscall(__NR_io_uring_register, this->mFd, IORING_REGISTER_PROBE, probe, SIZE_OPS) < 0)
+      return false;
+
+    for (auto &&op : v) {
+      if ((op > probe->last_op) || ((probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0))
+        return false;
+    }
+    return true;
+  }
+
+  // Returns a zeroed entry, or nullptr while the submission ring is full.
+  io_uring_sqe *getSqe() {
+    auto &&head = __atomic_load_n(this->sq<Juint>(this->mParams.sq_off.head), __ATOMIC_ACQUIRE);
+    auto &&tail = *this->sq<Juint>(this->mParams.sq_off.tail);
+    if (tail - head >= this->mParams.sq_entries)
+      return nullptr;
+
+    auto &&index = tail & *this->sq<Juint>(this->mParams.sq_off.ring_mask);
+    auto &&ret = &this->mSqes[index];
+    memset(ret, 0, sizeof(*ret));
+    this->sq<Juint>(this->mParams.sq_off.array)[index] = index;
+    __atomic_store_n(this->sq<Juint>(this->mParams.sq_off.tail), tail + 1, __ATOMIC_RELEASE);
+    ++this->mPending;
+    return ret;
+  }
+
+  Jint submit(Juint wait) {
+    auto &&flags = (wait > 0) ? IORING_ENTER_GETEVENTS : 0u;
+    auto &&ret = syscall(__NR_io_uring_enter, this->mFd, this->mPending, wait, flags, nullptr, 0);
+    if (ret < 0)
+      return ((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) ? 0 : -1;
+
+    this->mPending -= static_cast<Juint>(ret);
+    return static_cast<Jint>(ret);
+  }
+
+  template <class Fun> Juint forEachCqe(Fun &&fun) {
+    Juint ret = 0;
+
+    auto &&head = *this->cq<Juint>(this->mParams.cq_off.head);
+    auto &&tail = __atomic_load_n(this->cq<Juint>(this->mParams.cq_off.tail), __ATOMIC_ACQUIRE);
+    auto &&mask = *this->cq<Juint>(this->mParams.cq_off.ring_mask);
+    for (; head != tail; ++head, ++ret) {
+      auto &&cqe = this->cq<io_uring_cqe>(this->mParams.cq_off.cqes)[head & mask];
+      fun(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(this->cq<Juint>(this->mParams.cq_off.head), head, __ATOMIC_RELEASE);
+    return ret;
+  }
+};
+
+class BatchReader {
+private:
+  constexpr static Juint SIZE_RING = 256;
+  constexpr static Jsize SIZE_SLOT = 64;
+  constexpr static Jsize SIZE_INITIAL = 16 * 1024;
+  constexpr static Jsize SIZE_QUEUE = 8;
+
+  constexpr static uint64_t STEP_OPEN = 0;
+  constexpr static uint64_t STEP_READ = 1;
+  constexpr static uint64_t STEP_OTHER = 2;
+  constexpr static uint64_t STEP_MASK = 3;
+
+  class Slot {
+  public:
+    Jsize mIndex;
+    Jint mFd;
+    Jsize mRead;
+    std::string mData;
+
+    Slot() : mIndex(), mFd(-1), mRead(), mData() {}
+  };
+
+  Jint mThreads;
+  Jbool mClosed;
+  std::vector<Slot> mSlots;
+  std::vector<Jbyte> mDelivered;
+  std::mutex mMutex;
+  std::condition_variable mReady;
+  std::condition_variable mSpace;
+  std::list<std::pair<Jsize, std::string>> mQueue;
+
+  void push(Jsize index, std::string data) {
+    this->mDelivered[index] = 1;
+
+    std::unique_lock<std::mutex> lock(this->mMutex);
+    this->mSpace.wait(lock, [this]() {
+      return this->mQueue.size() < static_cast<Jsize>(this->mThreads) * SIZE_QUEUE;
+    });
+    this->mQueue.emplace_back(index, move(data));
+    this->mReady.notify_one();
+  }
+
+  Jbool pop(std::pair<Jsize, std::string> &v) {
+    std::unique_lock<std::mutex> lock(this->mMutex);
+    this->mReady.wait(lock, [this]() { return this->mClosed || !this->mQueue.empty(); });
+    if (this->mQueue.empty())
+      return false;
+
+    v = move(this->mQueue.front());
+    this->mQueue.pop_front();
+    this->mSpace.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    this->mClosed = true;
+    this->mReady.notify_all();
+  }
+
+  static void read(const std::string &path, std::string &v) {
+    struct stat info = {};
+    ssize_t retLen = 0;
+    Jsize length = 0;
+
+    v.clear();
+    auto &&fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    v.resize((fstat(fd, &info) == 0) && (info.st_size > 0) ? info.st_size + 1 : SIZE_INITIAL);
+    while ((retLen = ::read(fd, &v[length], v.size() - length)) > 0) {
+      length += retLen;
+      if (length == v.size())
+        v.resize(v.size() * 2);
+    }
+    v.resize(length);
+    ::close(fd);
+  }
+
+  static void prepare(io_uring_sqe *sqe, Jint op, Jint fd, uint64_t data) {
+    sqe->opcode = op;
+    sqe->fd = fd;
+    sqe->user_data = data;
+  }
+
+  // Opens, hints and reads every path through one ring; SIZE_SLOT files are in flight at
+  // once and each finished buffer is handed to the consumer threads.
+  Jbool produce(IoUring &ring, const std::vector<std::string> &paths) {
+    Jsize next = 0;
+    Jsize active = 0;
+    Jsize outstanding = 0;
+    std::vector<Jsize> free;
+
+    // Slots belong to the reader so buffers outlive the ring if it is torn down early.
+    auto &&slots = this->mSlots;
+    slots.resize(SIZE_SLOT);
+    this->mDelivered.resize(paths.size());
+
+    for (Jsize i = SIZE_SLOT; i > 0; --i)
+      free.push_back(i - 1);
+
+    auto &&getSqe = [&]() {
+      auto &&ret = ring.getSqe();
+      if ((ret == nullptr) && (ring.submit(0) > 0))
+        ret = ring.getSqe();
+      if (ret != nullptr)
+        ++outstanding;
+      return ret;
+    };
+
+    auto &&finish = [&](Jsize id) {
+      auto &&slot = slots[id];
+      if (slot.mFd >= 0) {
+        auto &&sqe = getSqe();
+        if (sqe != nullptr)
+          prepare(sqe, IORING_OP_CLOSE, slot.mFd, STEP_OTHER);
+        else
+          ::close(slot.mFd);
+      }
+      slot.mData.resize(slot.mRead);
+      this->push(slot.mIndex, move(slot.mData));
+      slot = Slot();
+      free.push_back(id);
+      --active;
+    };
+
+    auto &&submitRead = [&](Jsize id) {
+      auto &&slot = slots[id];
+      auto &&sqe = getSqe();
+      if (sqe == nullptr)
+        return false;
+
+      prepare(sqe, IORING_OP_READ, slot.mFd, (id << 2u) | STEP_READ);
+      sqe->addr = reinterpret_cast<uint64_t>(&slot.mData[slot.mRead]);
+      sqe->len = static_cast<Juint>(slot.mData.size() - slot.mRead);
+      sqe->off = slot.mRead;
+      return true;
+    };
+
+    while ((next < paths.size()) || (outstanding > 0)) {
+      while ((next < paths.size()) && !free.empty()) {
+        auto &&sqe = getSqe();
+        if (sqe == nullptr)
+          return false;
+
+        auto &&id = free.back();
+        free.pop_back();
+        ++active;
+        slots[id].mIndex = next;
+        prepare(sqe, IORING_OP_OPENAT, AT_FDCWD, (id << 2u) | STEP_OPEN);
+        sqe->addr = reinterpret_cast<uint64_t>(paths[next++].c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+      }
+
+      if (ring.submit(1) < 0)
+        return false;
+
+      ring.forEachCqe([&](uint64_t data, Jint res) {
+        auto &&id = static_cast<Jsize>(data >> 2u);
+        auto &&step = data & STEP_MASK;
+
+        --outstanding;
+        if (step == STEP_OTHER)
+          return;
+
+        auto &&slot = slots[id];
+        if (res < 0) {
+          slot.mRead = 0;
+          finish(id);
+        } else if (step == STEP_OPEN) {
+          slot.mFd = res;
+          slot.mData.resize(SIZE_INITIAL);
+          auto &&sqe = getSqe();
+          if (sqe != nullptr) {
+            prepare(sqe, IORING_OP_FADVISE, slot.mFd, STEP_OTHER);
+            sqe->fadvise_advice = POSIX_FADV_WILLNEED;
+          }
+          if (!submitRead(id))
+            finish(id);
+        } else {
+          slot.mRead += res;
+          if ((res == 0) || (slot.mRead < slot.mData.size())) {
+            finish(id);
+          } else {
+            slot.mData.resize(slot.mData.size() * 2);
+            if (!submitRead(id))
+              finish(id);
+          }
+        }
+      });
+    }
+    return (active == 0);
+  }
+
+  explicit BatchReader(Jint threads)
+      : mThreads(threads), mClosed(), mSlots(), mDelivered(), mMutex(), mReady(), mSpace(),
+        mQueue() {}
+
+public:
+  // Calls fun(index, data, worker) for every path as its content becomes available, in
+  // completion order and from up to threads workers. Files that cannot be read arrive empty;
+  // .gz files arrive decompressed.
+  template <class Fun>
+  static void forEach(const std::vector<std::string> &paths, Jint threads, Fun &&consume) {
+    Jint i = 0;
+    std::vector<std::thread> workers;
+
+    if (paths.empty())
+      return;
+    if (threads < 1)
+      threads = 1;
+
+    auto &&fun = [&paths, &consume](Jsize index, std::string &data, Jint worker) {
+      if (Gzip::isGzip(paths[index]) && !Gzip::decompress(data))
+        data.clear();
+      consume(index, data, worker);
+    };
+
+    auto &&reader = BatchReader(threads);
+    auto &&ring = IoUring(SIZE_RING);
+    if (!ring.isOpen() ||
+        !ring.isSupported({IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_FADVISE, IORING_OP_CLOSE})) {
+      auto &&buffers = std::vector<std::string>(threads);
+      Parallel::forEach(threads, paths.size(), [&](Jsize index, Jint worker) {
+        read(paths[index], buffers[worker]);
+        fun(index, buffers[worker], worker);
+      });
+      return;
+    }
+
+    for (i = 0; i < threads; ++i) {
+      workers.emplace_back([&reader, &fun](Jint worker) {
+        std::pair<Jsize, std::string> one;
+        while (reader.pop(one))
+          fun(one.first, one.second, worker);
+      }, i);
+    }
+
+    auto &&ret = reader.produce(ring, paths);
+    reader.close();
+    for (auto &&worker : workers)
+      worker.join();
+    ring.release();
+    if (ret)
+      return;
+
+    // The ring failed part way; read whatever was not delivered synchronously.
+    std::string buffer;
+    for (Jsize index = 0; index < paths.size(); ++index) {
+      if (reader.mDelivered[index] != 0)
+        continue;
+      read(paths[index], buffer);
+      fun(index, buffer, 0);
+    }
+  }
+};
+
 class File {
 private:
   std::list<UP<FileAttributes>> mFileAttributes;
@@ -242,6 +1409,17 @@ public:
 
   static Jint remove(std::string const &v) { return ::remove(v.data()); }
 
+  static Jbool read(std::string const &v, std::string &out) {
+    auto &&in = fopen(v.c_str(), "rb");
+    if (in == nullptr)
+      return false;
+
+    out.resize(File::getSize(in));
+    auto &&ret = (fread(&out[0], 1, out.size(), in) == out.size());
+    fclose(in);
+    return ret && (!Gzip::isGzip(v) || Gzip::decompress(out));
+  }
+
   static Jbool isFile(std::string const &v) { return (!std::filesystem::is_directory(v)); }
 
   static Jbool isExist(std::string const &v) { return std::filesystem::exists(v); }
@@ -253,8 +1431,9 @@ public:
     for (auto &&entry : iterator) {
       auto &&path = entry.path().parent_path().string();
       auto &&name = entry.path().filename().string();
-      auto &&exte = entry.path().extension().string();
-      if ((Suffix == nullptr) || (exte == Suffix))
+
+      // a.xml.gz is listed as an a.xml; readers decompress it on the way in.
+      if ((Suffix == nullptr) || (Gzip::getExtension(entry.path()) == Suffix))
         this->mFileAttributes.emplace_back(new FileAttributes(path, name));
     }
 
@@ -262,6 +1441,439 @@ public:
   }
 };
 
+// Input read as is: plain files are mapped, .gz files are decompressed into memory whole.
+// Only for readers that keep views into every line anyway (eval, dedupboxes), so the
+// decompressed size is what they would hold regardless; streaming readers use LineReader.
+class InputFile {
+private:
+  UP<MappedFile> mFile;
+  std::string mContent;
+  Jbool mOpen;
+
+public:
+  explicit InputFile(const std::string &v) : mFile(), mContent(), mOpen() {
+    if (Gzip::isGzip(v)) {
+      this->mOpen = File::read(v, this->mContent);
+      return;
+    }
+
+    this->mFile.reset(new MappedFile(v));
+    this->mOpen = this->mFile->isOpen();
+  }
+
+  InputFile(const InputFile &) = delete;
+
+  InputFile &operator=(const InputFile &) = delete;
+
+  [[nodiscard]] Jbool isOpen() const { return this->mOpen; }
+
+  [[nodiscard]] const Jchar *getData() const {
+    if (this->mFile == nullptr)
+      return this->mContent.data();
+    return reinterpret_cast<const Jchar *>(this->mFile->getData());
+  }
+
+  [[nodiscard]] Jsize getSize() const {
+    return (this->mFile == nullptr) ? this->mContent.size() : this->mFile->getSize();
+  }
+
+  void advise(Jint v) {
+    if (this->mFile != nullptr)
+      this->mFile->advise(v);
+  }
+
+  // Calls fun(line) for every line in order, the last one even without its newline.
+  template <class Fun> void forEachLine(Fun &&fun) const {
+    auto &&data = this->getData();
+    auto &&size = this->getSize();
+    for (Jsize begin = 0; begin < size;) {
+      auto &&lf = static_cast<const Jchar *>(memchr(&data[begin], '\n', size - begin));
+      auto &&stop = (lf == nullptr) ? size : static_cast<Jsize>(lf - data);
+      fun(std::string_view(&data[begin], stop - begin));
+      begin = stop + 1;
+    }
+  }
+};
+
+// Reports files written, moved or deleted directly inside one directory through inotify.
+class DirectoryWatch {
+private:
+  constexpr static Jsize SIZE_EVENTS = 64 * 1024;
+  constexpr static Juint MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+
+  Jint mFd;
+  std::vector<Jchar> mBuffer;
+
+public:
+  explicit DirectoryWatch(const std::string &directory) : mFd(-1), mBuffer(SIZE_EVENTS) {
+    this->mFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (this->mFd < 0)
+      return;
+    if (inotify_add_watch(this->mFd, directory.c_str(), MASK | IN_ONLYDIR) >= 0)
+      return;
+
+    close(this->mFd);
+    this->mFd = -1;
+  }
+
+  DirectoryWatch(const DirectoryWatch &) = delete;
+
+  DirectoryWatch &operator=(const DirectoryWatch &) = delete;
+
+  ~DirectoryWatch() {
+    if (this->mFd >= 0)
+      close(this->mFd);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFd >= 0); }
+
+  // Waits up to timeout milliseconds, -1 for ever, and calls fun(name) for every file that
+  // changed. Returns the number of events, 0 on timeout, or -1 when the kernel queue
+  // overflowed and the caller has to rescan the directory.
+  template <class Fun> Jint wait(Jint timeout, Fun &&fun) {
+    Jint count = 0;
+    ssize_t retLen = 0;
+    pollfd one = {this->mFd, POLLIN, 0};
+
+    if (poll(&one, 1, timeout) <= 0)
+      return 0;
+
+    while ((retLen = read(this->mFd, this->mBuffer.data(), this->mBuffer.size())) > 0) {
+      for (ssize_t i = 0; i < retLen;) {
+        auto &&event = reinterpret_cast<const inotify_event *>(&this->mBuffer[i]);
+        i += sizeof(inotify_event) + event->len;
+        if ((event->mask & IN_Q_OVERFLOW) != 0) {
+          count = -1;
+        } else if ((count >= 0) && (event->len > 0) && ((event->mask & IN_ISDIR) == 0)) {
+          fun(std::string(event->name));
+          ++count;
+        }
+      }
+    }
+    return count;
+  }
+};
+
+// Append-only record of finished units, one "input[\toutput...]\n" line each. Lines
+// are written and fdatasync'd every SIZE_SYNC units, so a crash redoes at most that many.
+class Journal {
+private:
+  constexpr static Jsize SIZE_SYNC = 256;
+  constexpr static Jsize SIZE_READ = 64 * 1024;
+  constexpr static Jchar SEPARATOR = '\t';
+  constexpr static Jchar END = '\n';
+  constexpr static Jchar FORMAT_NAME[] = ".%s.journal";
+  constexpr static Jchar FORMAT_TRUNCATE[] = "file: %s, journal truncate failed";
+  constexpr static Jchar FORMAT_WRITE[] = "file: %s, journal write failed";
+
+  Jint mFd;
+  std::string mPath;
+  Jsize mUnsynced;
+  std::string mBuffer;
+  std::mutex mMutex;
+  std::map<std::string, std::vector<std::string>> mDone;
+
+  void load() {
+    ssize_t retLen = 0;
+    std::string content;
+    std::vector<Jchar> buffer(SIZE_READ);
+
+    while ((retLen = read(this->mFd, buffer.data(), buffer.size())) > 0)
+      content.append(buffer.data(), retLen);
+
+    // A line without its END was torn by a crash and is cut off before appending. If it
+    // cannot be cut, it is ended instead so that it stays apart from the next line.
+    auto &&complete = content.rfind(END);
+    complete = (complete == std::string::npos) ? 0 : complete + 1;
+    if ((complete < content.size()) && (ftruncate(this->mFd, complete) != 0)) {
+      Log::error(FORMAT_TRUNCATE, this->mPath.c_str());
+      this->mBuffer.push_back(END);
+    }
+
+    for (Jsize begin = 0, end = 0; (end = content.find(END, begin)) != std::string::npos;
+         begin = end + 1) {
+      std::vector<std::string> fields;
+      auto &&line = std::string_view(&content[begin], end - begin);
+      for (Jsize mark = 0, next = 0; mark <= line.size(); mark = next + 1) {
+        next = std::min(line.find(SEPARATOR, mark), line.size());
+        fields.emplace_back(line.substr(mark, next - mark));
+      }
+      if (fields.front().empty())
+        continue;
+
+      auto input = fields.front();
+      fields.erase(fields.begin());
+      this->mDone[input] = move(fields);
+    }
+  }
+
+  void sync() {
+    Jsize mark = 0;
+
+    while (mark < this->mBuffer.size()) {
+      auto &&retLen = write(this->mFd, &this->mBuffer[mark], this->mBuffer.size() - mark);
+      if ((retLen < 0) && (errno == EINTR))
+        continue;
+      if (retLen <= 0)
+        break;
+      mark += retLen;
+    }
+    if ((mark < this->mBuffer.size()) || (fdatasync(this->mFd) != 0))
+      Log::error(FORMAT_WRITE, this->mPath.c_str());
+    this->mBuffer.clear();
+    this->mUnsynced = 0;
+  }
+
+public:
+  // Without resume the journal of a previous run is discarded.
+  Journal(const std::filesystem::path &directory, const Jchar *command, Jbool resume)
+      : mFd(-1), mPath(), mUnsynced(), mBuffer(), mMutex(), mDone() {
+    auto &&flags = O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC | (resume ? 0 : O_TRUNC);
+
+    this->mPath = (directory / String::format(FORMAT_NAME, command)).string();
+    this->mFd = open(this->mPath.c_str(), flags, 0644);
+    if ((this->mFd >= 0) && resume)
+      this->load();
+  }
+
+  Journal(const Journal &) = delete;
+
+  Journal &operator=(const Journal &) = delete;
+
+  ~Journal() {
+    if (this->mFd < 0)
+      return;
+    if (!this->mBuffer.empty())
+      this->sync();
+    close(this->mFd);
+  }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFd >= 0); }
+
+  [[nodiscard]] const std::string &getPath() const { return this->mPath; }
+
+  // A unit counts as done only while every output it recorded still exists.
+  [[nodiscard]] Jbool isDone(const std::string &input) const {
+    auto &&it = this->mDone.find(input);
+    if (it == this->mDone.end())
+      return false;
+
+    for (auto &&output : it->second) {
+      if (!File::isExist(output))
+        return false;
+    }
+    return true;
+  }
+
+  void add(const std::string &input, const std::vector<std::string> &outputs) {
+    std::lock_guard<std::mutex> lock(this->mMutex);
+
+    if (this->mFd < 0)
+      return;
+
+    this->mBuffer.append(input);
+    for (auto &&output : outputs)
+      this->mBuffer.append(1, SEPARATOR).append(output);
+    this->mBuffer.push_back(END);
+    if (++this->mUnsynced >= SIZE_SYNC)
+      this->sync();
+  }
+};
+
+// Streams a ustar archive. File bodies go from their descriptor to the archive through
+// sendfile and never pass through user space; names longer than the header allows get a pax
+// "path" record, sizes past 8 GiB use the base-256 size encoding.
+class TarWriter {
+private:
+  constexpr static Jsize SIZE_BLOCK = 512;
+  constexpr static Jsize SIZE_SEND = 1024 * 1024 * 1024;
+  constexpr static Juint MODE_FILE = 0644;
+  constexpr static Jchar TYPE_FILE = '0';
+  constexpr static Jchar TYPE_PAX = 'x';
+  constexpr static Jchar MAGIC[] = "ustar";
+  constexpr static Jchar VERSION[] = "00";
+  constexpr static Jchar NAME_PAX[] = "PaxHeader";
+  constexpr static Jchar FORMAT_PAX[] = "%zu path=%s\n";
+
+  struct Header {
+    Jchar mName[100];
+    Jchar mMode[8];
+    Jchar mUid[8];
+    Jchar mGid[8];
+    Jchar mSize[12];
+    Jchar mTime[12];
+    Jchar mChecksum[8];
+    Jchar mType;
+    Jchar mLink[100];
+    Jchar mMagic[6];
+    Jchar mVersion[2];
+    Jchar mUser[32];
+    Jchar mGroup[32];
+    Jchar mMajor[8];
+    Jchar mMinor[8];
+    Jchar mPrefix[155];
+    Jchar mPad[12];
+  };
+
+  static_assert(sizeof(Header) == SIZE_BLOCK, "a tar header is one block");
+
+  Jint mFd;
+  Jlong mSize;
+  Jbool mFailed;
+
+  static Jsize getPadding(Jsize size) { return (SIZE_BLOCK - size % SIZE_BLOCK) % SIZE_BLOCK; }
+
+  // The record length counts its own digits.
+  static std::string getPax(const std::string &name) {
+    auto &&base = String::format(FORMAT_PAX, static_cast<Jsize>(0), name.c_str()).size() - 1;
+    auto size = base + 1;
+    while (base + std::to_string(size).size() != size)
+      size = base + std::to_string(size).size();
+    return String::format(FORMAT_PAX, size, name.c_str());
+  }
+
+  static void octal(Jchar *field, Jsize width, Julong v) {
+    if (v < (1ull << (3 * (width - 1)))) {
+      snprintf(field, width, "%0*lo", static_cast<Jint>(width - 1), v);
+      return;
+    }
+
+    field[0] = static_cast<Jchar>(0x80);
+    for (auto i = width - 1; i > 0; --i, v >>= 8)
+      field[i] = static_cast<Jchar>(v & 0xff);
+  }
+
+  void put(const void *data, Jsize size) {
+    Jsize mark = 0;
+
+    while (!this->mFailed && (mark < size)) {
+      auto &&retLen = ::write(this->mFd, static_cast<const Jchar *>(data) + mark, size - mark);
+      if ((retLen < 0) && (errno == EINTR))
+        continue;
+      this->mFailed = (retLen <= 0);
+      mark += std::max<ssize_t>(retLen, 0);
+    }
+    this->mSize += mark;
+  }
+
+  void pad(Jsize size) {
+    const Jchar zeros[SIZE_BLOCK] = {};
+    this->put(zeros, getPadding(size));
+  }
+
+  void header(const std::string &name, Jsize size, Juint mode, Jlong time, Jchar type) {
+    Header one = {};
+    Juint sum = 0;
+
+    memcpy(one.mName, name.data(), std::min(name.size(), sizeof(one.mName)));
+    octal(one.mMode, sizeof(one.mMode), mode & 07777);
+    octal(one.mUid, sizeof(one.mUid), 0);
+    octal(one.mGid, sizeof(one.mGid), 0);
+    octal(one.mSize, sizeof(one.mSize), size);
+    octal(one.mTime, sizeof(one.mTime), static_cast<Julong>(std::max(time, 0ll)));
+    one.mType = type;
+    memcpy(one.mMagic, MAGIC, sizeof(MAGIC));
+    memcpy(one.mVersion, VERSION, sizeof(one.mVersion));
+
+    memset(one.mChecksum, ' ', sizeof(one.mChecksum));
+    for (auto &&byte : std::string_view(reinterpret_cast<const Jchar *>(&one), sizeof(one)))
+      sum += static_cast<Jbyte>(byte);
+    snprintf(one.mChecksum, sizeof(one.mChecksum), "%06o", sum);
+    one.mChecksum[sizeof(one.mChecksum) - 1] = ' ';
+    this->put(&one, sizeof(one));
+  }
+
+  void entry(const std::string &name, Jsize size, Juint mode, Jlong time) {
+    if (name.size() > sizeof(Header::mName)) {
+      auto &&pax = getPax(name);
+      this->header(NAME_PAX, pax.size(), MODE_FILE, time, TYPE_PAX);
+      this->put(pax.data(), pax.size());
+      this->pad(pax.size());
+    }
+    this->header(name, size, mode, time, TYPE_FILE);
+  }
+
+public:
+  explicit TarWriter(const std::string &path) : mFd(-1), mSize(), mFailed() {
+    this->mFd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, MODE_FILE);
+    this->mFailed = (this->mFd < 0);
+  }
+
+  TarWriter(const TarWriter &) = delete;
+
+  TarWriter &operator=(const TarWriter &) = delete;
+
+  ~TarWriter() { this->close(); }
+
+  [[nodiscard]] Jbool isOpen() const { return (this->mFd >= 0); }
+
+  [[nodiscard]] Jlong getSize() const { return this->mSize; }
+
+  // Bytes one file adds to an archive, headers and padding included.
+  static Jsize getEntrySize(const std::string &name, Jsize size) {
+    auto ret = SIZE_BLOCK + size + getPadding(size);
+    if (name.size() > sizeof(Header::mName)) {
+      auto &&pax = getPax(name).size();
+      ret += SIZE_BLOCK + pax + getPadding(pax);
+    }
+    return ret;
+  }
+
+  // Bytes the end-of-archive marker adds on close.
+  static Jsize getEndSize() { return SIZE_BLOCK * 2; }
+
+  Jbool add(const std::string &name, const Jchar *data, Jsize size, Jlong time) {
+    this->entry(name, size, MODE_FILE, time);
+    this->put(data, size);
+    this->pad(size);
+    return !this->mFailed;
+  }
+
+  Jbool add(const std::string &name, const std::string &path) {
+    struct stat info = {};
+    off_t offset = 0;
+
+    if (this->mFailed)
+      return false;
+
+    auto &&in = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+      return false;
+    if (fstat(in, &info) != 0) {
+      ::close(in);
+      return false;
+    }
+
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    this->entry(name, info.st_size, info.st_mode, info.st_mtime);
+    while (!this->mFailed && (offset < info.st_size)) {
+      auto &&retLen = sendfile(this->mFd, in, &offset,
+                               std::min<Jsize>(info.st_size - offset, SIZE_SEND));
+      if ((retLen < 0) && (errno == EINTR))
+        continue;
+      this->mFailed = (retLen <= 0);
+    }
+    ::close(in);
+
+    // The header already promised st_size bytes; a file that shrank breaks the archive.
+    this->mSize += offset;
+    this->pad(info.st_size);
+    return !this->mFailed;
+  }
+
+  // Ends the archive with two zero blocks; false if any write failed.
+  Jbool close() {
+    if (this->mFd < 0)
+      return !this->mFailed;
+
+    const Jchar zeros[SIZE_BLOCK * 2] = {};
+    this->put(zeros, sizeof(zeros));
+    this->mFailed = (::close(this->mFd) != 0) || this->mFailed;
+    this->mFd = -1;
+    return !this->mFailed;
+  }
+};
+
 } // namespace tfutils
 
 #endif // TFUTILS_TF_COMMON_HPP
@@ -1,22 +1,45 @@
 #ifndef TFUTILS_TF_CORE_HPP
 #define TFUTILS_TF_CORE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
 
 #include <list>
+#include <map>
+#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include <QtGui/QImage>
 #include <QtXml/QtXml>
 
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <linux/io_uring.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <spawn.h>
 #include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <zlib.h>
 
 using Jchar = char;
 using Jint = int;
@@ -27,6 +50,7 @@ using Julong = unsigned long;
 using Jbool = bool;
 using Jsize = size_t;
 using Jfloat = float;
+using Jdouble = double;
 
 template <class T> struct RemoveType { using Type = T; };
 
@@ -49,6 +73,16 @@ constexpr static SP<typename RemoveType<T>::Type> make(Args... args) {
 #include "tf_command_adb.hpp"
 #include "tf_command_os.hpp"
 #include "tf_command_tensorflow_impl.hpp"
+#include "tf_command_tensorflow_column.hpp"
 #include "tf_command_tensorflow_in.hpp"
 
+#include "tf_command_tensorflow_box.hpp"
+#include "tf_command_tensorflow_dataset.hpp"
+#include "tf_command_tensorflow_eval.hpp"
+#include "tf_command_tensorflow_image.hpp"
+#include "tf_command_tensorflow_export.hpp"
+#include "tf_command_tensorflow_record.hpp"
+#include "tf_command_tensorflow_external.hpp"
+#include "tf_command_tensorflow_pack.hpp"
+
 #endif // TFUTILS_TF_CORE_HPP